@@ -11,9 +11,14 @@
 #include <string.h>
 #include <time.h>
 #include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
 
 void c_save( char *file )
 {	register int i;
+	register struct game_ctx *gp = cur_game;
 	FILE *outfile;
 	extern char *version;
 	char *nicedate();
@@ -36,9 +41,9 @@ void c_save( char *file )
 	fprintf( outfile, "#   Game saved:  %s\n", nicedate(time(0)));
 	fprintf( outfile, "#   Game name:   %s\n", gamename );
 
-	if (boardsize != MAXBOARD)
+	if (gp->g_size != DEFBOARD)
 		fprintf( outfile, "n %d\t(game played on a %d line board)\n",
-			 boardsize, boardsize );
+			 gp->g_size, gp->g_size );
 
 	fprintf( outfile, "p %s\n", p_name );
 	if (p_ability)
@@ -50,8 +55,8 @@ void c_save( char *file )
 		fprintf( outfile, "o b\t(%s said he wanted to)\n", p_name);
 
 	/* write out all of the moves */
-	for( i = 1; i < movenum; i++ )
-		m_logmove( outfile, i );
+	for( i = 1; i < gp->g_movenum; i++ )
+		m_logmove( gp, outfile, i );
 
 	(void) fclose( outfile );
 	d_msg( "%d moves saved to file %s", i-1, file );
@@ -107,7 +112,7 @@ void c_replay( char *arg )
 		darkness = TRUE;
 	}
 
-	for( limit = moves + movenum; movenum < limit; )
+	for( limit = moves + cur_game->g_movenum; cur_game->g_movenum < limit; )
 	{	/* read the input line */
 		if (fgets( cmdbuf, MAXLINE, rfile ) == NULL)
 		{	d_msg( "End of file on %s", name );
@@ -129,10 +134,108 @@ void c_replay( char *arg )
 
 	if (moves > 2)
 	{	darkness = save;
-		b_redraw( TRUE );
+		b_redraw( cur_game, TRUE );
 	}
 }
 
+/*
+ * routine:
+ *	a_point
+ *
+ * purpose:
+ *	to find the point named by a position in a game record
+ *
+ * parms:
+ *	position (<col><row> or <row><col>)
+ *	size of the board
+ *
+ * returns:
+ *	point number
+ *	0 - the position is not on the board
+ */
+static int a_point( char *s, int size )
+{	register int row = 0;
+	register int col = 0;
+
+	if ((col = COLNUM( *s )) != 0)
+		s++;
+	while( *s >= '0'  &&  *s <= '9' )
+		row = row * 10 + *s++ - '0';
+	if (col == 0)
+		col = COLNUM( *s );
+
+	if (row <= 0  ||  row > size  ||  col <= 0  ||  col > size)
+		return( 0 );
+	return( P_INDEX( row, col ) );
+}
+
+/*
+ * routine:
+ *	a_record
+ *
+ * purpose:
+ *	to read the moves of a saved game, without playing them
+ *
+ * parms:
+ *	name of the file
+ *	where to put the record
+ *
+ * returns:
+ *	number of moves read
+ *	-1 - the file could not be opened
+ *
+ * note:
+ *	only the commands that a saved game is made of (see c_save) are
+ *	understood: n sets the board size, b, w and B make moves, and
+ *	a bare position is a move by whoever is to play next.  Anything
+ *	else is ignored, as is a move that is off the board.
+ */
+int a_record( char *file, struct record *rp )
+{	register char *s;
+	FILE *infile;
+	char line[ MAXLINE ];
+	int color, next, pt;
+
+	if ((infile = fopen( file, "r" )) == NULL)
+		return( -1 );
+
+	rp->r_size = DEFBOARD;
+	rp->r_nmoves = 0;
+	next = BLACK;
+	while( rp->r_nmoves < MAXRECORD  &&  fgets( line, MAXLINE, infile ) != NULL )
+	{	for( s = line; *s == ' '  ||  *s == '\t'; s++ )
+			;
+
+		/* a move by whoever is to play next */
+		if ((COLNUM( *s )  &&  s[1] >= '0'  &&  s[1] <= '9')  ||
+			(*s >= '0'  &&  *s <= '9'))
+			color = next;
+		else if (*s == 'n'  &&  (s[1] == ' '  ||  s[1] == '\t'))
+		{	rp->r_size = atoi( s+2 );
+			if (rp->r_size > MAXBOARD  ||  rp->r_size < 5)
+				rp->r_size = DEFBOARD;
+			continue;
+		} else if ((*s == 'b'  ||  *s == 'B'  ||  *s == 'w')  &&
+			(s[1] == ':'  ||  s[1] == ' '  ||  s[1] == '\t'))
+		{	color = (*s == 'w') ? WHITE : BLACK;
+			for( s++; *s == ':'  ||  *s == ' '  ||  *s == '\t'; s++ );
+		} else
+			continue;
+
+		if (*s == '-')
+			pt = 0;
+		else if ((pt = a_point( s, rp->r_size )) == 0)
+			continue;
+
+		rp->r_point[ rp->r_nmoves ] = pt;
+		rp->r_color[ rp->r_nmoves++ ] = color;
+		next = !color;
+	}
+
+	(void) fclose( infile );
+	return( rp->r_nmoves );
+}
+
 /*
  * routine:
  *	nicedate
@@ -0,0 +1,208 @@
+/*
+ * module:
+ *	benson.c
+ *
+ * purpose:
+ *	to find the strings that are unconditionally alive (Benson's
+ *	algorithm), and the regions that their owners hold for good
+ *
+ * note:
+ *	for each color, the board is divided into strings of that color
+ *	and regions (connected sets of points that are vacant or hold
+ *	enemy stones).  A region is vital to a string next to it if every
+ *	vacant point in the region is one of the string's liberties.  At
+ *	first every string and region is presumed safe; then, over and
+ *	over, a string with fewer than two vital regions that are still
+ *	safe is given up, and so is every region next to a string that has
+ *	been given up, until nothing changes.  The strings that are left
+ *	cannot be captured, even if their owner never moves again, and the
+ *	enemy can never live in the regions left that are vital to them.
+ *
+ *	Once found, such strings and regions stay safe for the rest of the
+ *	game (or until a move is taken back), so the results are kept in
+ *	the game's safe board (g_safe), and recomputed only after the moves
+ *	that are made and unmade at the console (and when a game is reset
+ *	or copied), not in the imaginary moves of searches and playouts.
+ */
+#include <stdio.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+
+#define U_NONE		-1		/* point in no string or region */
+#define U_MAXPAIRS	(4 * MAXBOARD * MAXBOARD) /* most string/region pairs */
+
+/* a string next to a region, and the region's vacant points it touches */
+struct upair
+{	short	u_region;	/* number of the region */
+	short	u_string;	/* number of the string */
+	short	u_touched;	/* vacant points in the region next to it */
+};
+
+/*
+ * routine:
+ *	u_color
+ *
+ * purpose:
+ *	to find the strings of one color that are unconditionally alive,
+ *	and the regions they hold
+ *
+ * parms:
+ *	game to be examined
+ *	color to be examined
+ */
+static void u_color( struct game_ctx *gp, int color )
+{	register struct string *sp;
+	register struct upair *up;
+	register int pt, i, k;
+	int r, q, next, nstr, nreg, npairs, first, bit, changed;
+	int nstack, nvacant;
+	short strno[ P_POINTS ], regno[ P_POINTS ];
+	short stack[ MAXBOARD * MAXBOARD ];
+	short vacant[ MAXBOARD * MAXBOARD ];	/* vacant points in each region */
+	char salive[ MAXBOARD * MAXBOARD ];	/* each string still safe */
+	char ralive[ MAXBOARD * MAXBOARD ];	/* each region still safe */
+	char rheld[ MAXBOARD * MAXBOARD ];	/* each region held for good */
+	char nvital[ MAXBOARD * MAXBOARD ];	/* safe vital regions of each string */
+	int near[4];
+	struct upair pairs[ U_MAXPAIRS ];
+
+	for( pt = 0; pt < P_POINTS; pt++ )
+		strno[pt] = regno[pt] = U_NONE;
+
+	/* number the strings of this color */
+	nstr = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	sp = &gp->g_str[pt];
+			if (sp->s_moveno <= 0  ||  sp->s_color != color  ||
+				strno[pt] != U_NONE)
+				continue;
+			q = pt;
+			do
+			{	strno[q] = nstr;
+				q = gp->g_str[q].s_next;
+			} while( q != pt );
+			salive[ nstr++ ] = TRUE;
+		}
+
+	/* find the regions, and the strings next to each */
+	nreg = npairs = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	if (strno[pt] != U_NONE  ||  regno[pt] != U_NONE)
+				continue;
+
+			first = npairs;
+			nvacant = 0;
+			regno[pt] = nreg;
+			stack[0] = pt;
+			nstack = 1;
+			while( nstack > 0 )
+			{	q = stack[ --nstack ];
+				sp = &gp->g_str[q];
+				if (sp->s_moveno == 0)
+					nvacant++;
+
+				/* note each string next to it just once */
+				for( i = 0; i < 4; i++ )
+				{	near[i] = strno[ q + p_adj[i] ];
+					for( k = 0; k < i; k++ )
+						if (near[k] == near[i])
+							near[i] = U_NONE;
+				}
+
+				for( i = 0; i < 4; i++ )
+				{	if (near[i] != U_NONE)
+					{	for( up = &pairs[first]; up < &pairs[npairs]; up++ )
+							if (up->u_string == near[i])
+								break;
+						if (up == &pairs[npairs])
+						{	if (npairs >= U_MAXPAIRS)
+								return;
+							up->u_region = nreg;
+							up->u_string = near[i];
+							up->u_touched = 0;
+							npairs++;
+						}
+						if (sp->s_moveno == 0)
+							up->u_touched++;
+						continue;
+					}
+
+					/* and spread out over vacant points and enemy stones */
+					next = q + p_adj[i];
+					if (gp->g_str[next].s_moveno >= 0  &&
+						strno[next] == U_NONE  &&  regno[next] == U_NONE)
+					{	regno[next] = nreg;
+						stack[ nstack++ ] = next;
+					}
+				}
+			}
+			vacant[nreg] = nvacant;
+			ralive[ nreg++ ] = TRUE;
+		}
+
+	/* give up strings and regions until only the safe ones are left */
+	do
+	{	for( k = 0; k < nstr; k++ )
+			nvital[k] = 0;
+		for( up = pairs; up < &pairs[npairs]; up++ )
+			if (ralive[ up->u_region ]  &&
+				up->u_touched == vacant[ up->u_region ]  &&
+				nvital[ up->u_string ] < 2)
+				nvital[ up->u_string ]++;
+
+		changed = FALSE;
+		for( k = 0; k < nstr; k++ )
+			if (salive[k]  &&  nvital[k] < 2)
+			{	salive[k] = FALSE;
+				changed = TRUE;
+			}
+		for( up = pairs; up < &pairs[npairs]; up++ )
+			if (ralive[ up->u_region ]  &&  !salive[ up->u_string ])
+				ralive[ up->u_region ] = FALSE;
+	} while( changed );
+
+	/* a safe region is held only if it is vital to a safe string */
+	for( k = 0; k < nreg; k++ )
+		rheld[k] = FALSE;
+	for( up = pairs; up < &pairs[npairs]; up++ )
+		if (ralive[ up->u_region ]  &&  up->u_touched == vacant[ up->u_region ])
+			rheld[ up->u_region ] = TRUE;
+
+	/* and mark everything that is safe */
+	bit = 1 << color;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if ((strno[pt] != U_NONE  &&  salive[ strno[pt] ])  ||
+				(regno[pt] != U_NONE  &&  rheld[ regno[pt] ]))
+				gp->g_safe[pt] |= bit;
+}
+
+/*
+ * routine:
+ *	u_update
+ *
+ * purpose:
+ *	to bring the safe board of a game up to date
+ *
+ * parms:
+ *	game to be brought up to date
+ *
+ * note:
+ *	a point's entry in the safe board has bit (1 << color) set if it
+ *	is held for good by that color: if it holds one of the color's
+ *	unconditionally alive stones, or lies in a region vital to them.
+ */
+void u_update( struct game_ctx *gp )
+{	register int pt;
+
+	for( pt = 0; pt < P_POINTS; pt++ )
+		gp->g_safe[pt] = 0;
+
+	u_color( gp, BLACK );
+	u_color( gp, WHITE );
+}
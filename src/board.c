@@ -8,6 +8,10 @@
 #include <stdio.h>
 #include "go.h"
 #include "disp.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
 
 /*
  * routine:
@@ -15,19 +19,22 @@
  *
  * purpose:
  *	to reset the board to be empty
+ *
+ * parameters:
+ *	game whose board is to be reset
  */
- void b_reset()
+ void b_reset( struct game_ctx *gp )
  {	register int i;
-	register unsigned short *p, *e;
+	register unsigned long *p, *e;
 
 	/* reset the board */
-	i = sizeof dsp_board / sizeof (*p);
-	p = &dsp_board[0][0];
+	i = sizeof gp->g_dsp / sizeof (*p);
+	p = &gp->g_dsp[0];
 	e = &p[i];
 	while( p < e )
 		*p++ = 0;
 
-	b_redraw( TRUE );
+	b_redraw( gp, TRUE );
  }
 
 /*
@@ -38,6 +45,7 @@
  *	to set a particular board position
  *
  * parameters:
+ *	game whose board is to be updated
  *	row, col, 
  *	color
  *	stone type
@@ -47,17 +55,17 @@
  * returns:
  *	previous contents
  */
-unsigned short b_set( unsigned row, unsigned col, unsigned color, int type, int shade, int moveno )
- {	register short save, new;
+unsigned long b_set( struct game_ctx *gp, unsigned row, unsigned col, unsigned color, int type, int shade, int moveno )
+ {	register unsigned long save, new;
 
- 	save = dsp_board[ row-1 ][ col-1 ];
+ 	save = gp->g_dsp[ P_INDEX( row, col ) ];
 
 	/* update the board */
-	new = ((color*B_COLOR) | type | shade | moveno);
-	dsp_board[ row-1 ][ col-1 ] = new;
+	new = ((color*B_COLOR) | type | shade | B_NUMBER( moveno ));
+	gp->g_dsp[ P_INDEX( row, col ) ] = new;
 
 	/* update the screen */
-	b_update( row, col );
+	b_update( gp, row, col );
 
 	return( save );
 }
@@ -71,6 +79,7 @@ unsigned short b_set( unsigned row, unsigned col, unsigned color, int type, int
  *	to set tags associated with a position
  *
  * parameters:
+ *	game whose board is to be updated
  *	row, col
  *	type
  *	shade
@@ -78,18 +87,18 @@ unsigned short b_set( unsigned row, unsigned col, unsigned color, int type, int
  * returns:
  *	previous contents
  */
-unsigned short b_tag( unsigned row, unsigned col, int type, int shade )
- {	register short save, new;
+unsigned long b_tag( struct game_ctx *gp, unsigned row, unsigned col, int type, int shade )
+ {	register unsigned long save, new;
 
- 	save = dsp_board[ row-1 ][ col-1 ];
+ 	save = gp->g_dsp[ P_INDEX( row, col ) ];
 
 	/* update the board */
 	new = save & ~(B_SHADE+B_TYPE);
 	new |= shade + type;
-	dsp_board[ row-1 ][ col-1 ] = new;
+	gp->g_dsp[ P_INDEX( row, col ) ] = new;
 
 	/* update the screen */
-	b_update( row, col );
+	b_update( gp, row, col );
 
 	return( save );
 }
@@ -102,15 +111,16 @@ unsigned short b_tag( unsigned row, unsigned col, int type, int shade )
  *	to remove a dead stone from the board
  *
  * parmameters:
+ *	game whose board is to be updated
  *	row, col
  *
  * returns:
  *	void
  */
- void b_remove( unsigned row, unsigned col )
+ void b_remove( struct game_ctx *gp, unsigned row, unsigned col )
 {
-	dsp_board[row-1][col-1] = 0;
-	b_update( row, col );
+	gp->g_dsp[ P_INDEX( row, col ) ] = 0;
+	b_update( gp, row, col );
 }
 
 /*
@@ -121,18 +131,22 @@ unsigned short b_tag( unsigned row, unsigned col, int type, int shade )
  *	to update a position on the screen
  *
  * parameters:
+ *	game whose board is being displayed
  *	row, col to be updated
+ *
+ * note:
+ *	only the console game is ever shown on the screen
  */
- void b_update( unsigned row, unsigned col )
- {	register short value;
+ void b_update( struct game_ctx *gp, unsigned row, unsigned col )
+ {	register unsigned long value;
 	unsigned color;
 	int shade, num;
 
-	if (darkness)
+	if (darkness  ||  gp->g_fantasy)
 		return;
 
 	/* find out about the indicated board position */
-	value = dsp_board[ row-1 ][ col-1 ];
+	value = gp->g_dsp[ P_INDEX( row, col ) ];
 	color = B_WHT_STONE( value ) ? WHITE : BLACK;
 	num   = B_MOVENUM( value );
 	shade = value & B_SHADE;
@@ -167,14 +181,15 @@ unsigned short b_tag( unsigned row, unsigned col, int type, int shade )
  *	to reconstruct the entire board screen
  *
  * parms:
+ *	game to be displayed
  *	whether to redraw entire screen, or merely the board
  */
-void b_redraw( int all )
+void b_redraw( struct game_ctx *gp, int all )
  {	register unsigned row, col;
  	register int i;
 	extern int d_histlen;	/* imported from display module */
 
-	if (darkness)
+	if (darkness  ||  gp->g_fantasy)
 		return;
 
 	if (all)
@@ -182,19 +197,19 @@ void b_redraw( int all )
 		d_clear();
 
 		/* re-display the last screen-full of move history */
-		if (movenum-1 > d_histlen)
-			i = movenum - d_histlen;
+		if (gp->g_movenum-1 > d_histlen)
+			i = gp->g_movenum - d_histlen;
 		else
 			i = 1;
 
-		while( i < movenum )
-			m_logmove( (FILE *) NULL, i++ );
+		while( i < gp->g_movenum )
+			m_logmove( gp, (FILE *) NULL, i++ );
 	}
 
 	/* initialize every point on the blank board */
-	for( row = 1; row <= boardsize; row++ )
-		for( col = 1; col <= boardsize; col++ )
-			b_update( row, col );
+	for( row = 1; row <= gp->g_size; row++ )
+		for( col = 1; col <= gp->g_size; col++ )
+			b_update( gp, row, col );
 
 	/* and force it all to really happen */
 	d_update();
@@ -207,12 +222,16 @@ void b_redraw( int all )
  * purpose:
  *	to set the size of the board and locate the handicap points
  *
+ * parms:
+ *	game whose board size is being set
+ *	number of lines on the board
+ *
  * note:
  *	we initialize handicap points in reverse order so that 
  *	on smaller boards, overlapping points will get the smaller
  *	numbers
  */
-void b_boardsize( int size )
+void b_boardsize( struct game_ctx *gp, int size )
 {	
 	register int row, col;
 	int min_ha;	/* near fourth line */
@@ -224,9 +243,14 @@ void b_boardsize( int size )
 	int max_huh;	/* far quarter line */
 
 	if (size > MAXBOARD || size < 5)
-	{	d_msg("Ridiculous board size - %d assumed", MAXBOARD );
-		size = MAXBOARD;
+	{	d_msg("Ridiculous board size - %d assumed", DEFBOARD );
+		size = DEFBOARD;
 	}
+	gp->g_size = size;
+
+	/* only the displayed game needs to know about handicap points */
+	if (gp->g_fantasy)
+		return;
 	boardsize = size;
 
 	/* start with a cleared board */
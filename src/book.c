@@ -0,0 +1,696 @@
+/*
+ * module:
+ *	book.c
+ *
+ * purpose:
+ *	to build an opening book from a directory of saved games, and to
+ *	look up the moves played in the early positions of a game in it
+ *
+ * note:
+ *	see book.h for how positions and moves are put in the book, and
+ *	how the book file is laid out.  A book is built in memory, written
+ *	to a file, and then used by mapping that file.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "go.h"
+#include "disp.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "zobrist.h"
+#include "book.h"
+
+static int b_limit = B_DEPTH;	/* moves for which the book is used */
+
+/* the book in use (mapped from its file) */
+static char *b_map;		/* the whole file */
+static size_t b_maplen;		/* its length */
+static struct bheader *b_book;	/* its header */
+static struct bentry *b_entries; /* and its entries */
+
+/* the book being built: an entry for each move of each game */
+static struct bentry *b_built;
+static int b_nbuilt;		/* number of entries */
+static int b_maxbuilt;		/* number there is room for */
+
+/*
+ * routine:
+ *	b_turn
+ *
+ * purpose:
+ *	to find where a point goes when the board is turned
+ *
+ * parms:
+ *	point number
+ *	symmetry (bit 0 - exchange rows and columns, bit 1 - reflect the
+ *		rows, bit 2 - reflect the columns, in that order)
+ *	size of the board
+ *
+ * returns:
+ *	point number on the turned board
+ */
+static int b_turn( int pt, int sym, int size )
+{	int row = P_ROW( pt );
+	int col = P_COL( pt );
+	int t;
+
+	if (sym & 1)
+	{	t = row;
+		row = col;
+		col = t;
+	}
+	if (sym & 2)
+		row = size - row + 1;
+	if (sym & 4)
+		col = size - col + 1;
+	return( P_INDEX( row, col ) );
+}
+
+/*
+ * routine:
+ *	b_unturn
+ *
+ * purpose:
+ *	to find where a point of a turned board came from (undoing b_turn)
+ *
+ * parms:
+ *	point number on the turned board
+ *	symmetry it was turned by
+ *	size of the board
+ *
+ * returns:
+ *	point number
+ */
+static int b_unturn( int pt, int sym, int size )
+{	int row = P_ROW( pt );
+	int col = P_COL( pt );
+	int t;
+
+	if (sym & 4)
+		col = size - col + 1;
+	if (sym & 2)
+		row = size - row + 1;
+	if (sym & 1)
+	{	t = row;
+		row = col;
+		col = t;
+	}
+	return( P_INDEX( row, col ) );
+}
+
+/*
+ * routine:
+ *	b_hash
+ *
+ * purpose:
+ *	to find the canonical hash of a position
+ *
+ * parms:
+ *	game whose position is wanted
+ *	color of the player to move
+ *	where to put the hash of the position under each symmetry
+ *
+ * returns:
+ *	canonical hash (the least of them)
+ */
+static hash_t b_hash( struct game_ctx *gp, int color, hash_t *hashes )
+{	register int pt, r, s;
+	register struct string *sp;
+	hash_t least;
+
+	for( s = 0; s < 8; s++ )
+		hashes[s] = (color == WHITE) ? B_WHITEKEY : 0;
+
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	sp = &gp->g_str[pt];
+			if (sp->s_moveno == 0)
+				continue;
+			for( s = 0; s < 8; s++ )
+				hashes[s] ^= Z_STONE( (int) sp->s_color,
+					b_turn( pt, s, gp->g_size ) );
+		}
+
+	for( least = hashes[0], s = 1; s < 8; s++ )
+		if (hashes[s] < least)
+			least = hashes[s];
+	return( least );
+}
+
+/*
+ * routine:
+ *	b_canon
+ *
+ * purpose:
+ *	to turn a move the way that gives a position its canonical hash
+ *
+ * parms:
+ *	point of the move
+ *	hashes of the position under each symmetry (see b_hash)
+ *	canonical hash
+ *	size of the board
+ *
+ * returns:
+ *	point of the turned move
+ *
+ * note:
+ *	if the position looks the same turned more than one way, the move
+ *	might be turned any of those ways, and the least is taken.
+ */
+static int b_canon( int pt, hash_t *hashes, hash_t least, int size )
+{	register int s, t;
+	int best = 0;
+
+	for( s = 0; s < 8; s++ )
+		if (hashes[s] == least)
+		{	t = b_turn( pt, s, size );
+			if (best == 0  ||  t < best)
+				best = t;
+		}
+	return( best );
+}
+
+/*
+ * routine:
+ *	b_close
+ *
+ * purpose:
+ *	to stop using the book
+ */
+void b_close()
+{
+	if (b_map)
+		(void) munmap( b_map, b_maplen );
+	b_map = 0;
+	b_maplen = 0;
+	b_book = 0;
+	b_entries = 0;
+}
+
+/*
+ * routine:
+ *	b_open
+ *
+ * purpose:
+ *	to start using a book (instead of any we had)
+ *
+ * parms:
+ *	name of the book file
+ *	TRUE if a missing file should be complained about
+ *
+ * returns:
+ *	number of entries in it
+ *	-1 - it could not be used
+ */
+int b_open( char *file, int loud )
+{	struct stat st;
+	struct bheader *hp;
+	char *map;
+	int fd;
+
+	if ((fd = open( file, O_RDONLY )) < 0)
+	{	if (loud)
+			d_msg( "Unable to open book file: %s", file );
+		return( -1 );
+	}
+
+	map = MAP_FAILED;
+	if (fstat( fd, &st ) == 0  &&  st.st_size >= sizeof (struct bheader))
+		map = (char *) mmap( 0, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	(void) close( fd );
+	if (map == MAP_FAILED)
+	{	d_msg( "Unable to map book file: %s", file );
+		return( -1 );
+	}
+
+	/* make sure it is what it claims to be */
+	hp = (struct bheader *) map;
+	if (memcmp( hp->b_magic, B_MAGIC, sizeof hp->b_magic ) != 0  ||
+		hp->b_nentries < 0  ||  st.st_size != sizeof (struct bheader) +
+		(size_t) hp->b_nentries * sizeof (struct bentry))
+	{	d_msg( "Not an opening book: %s", file );
+		(void) munmap( map, (size_t) st.st_size );
+		return( -1 );
+	}
+
+	b_close();
+	b_map = map;
+	b_maplen = (size_t) st.st_size;
+	b_book = hp;
+	b_entries = (struct bentry *) (map + sizeof (struct bheader));
+	return( hp->b_nentries );
+}
+
+/*
+ * routine:
+ *	b_find
+ *
+ * purpose:
+ *	to find the moves for a position in the book
+ *
+ * parms:
+ *	canonical hash of the position
+ *	where to put the number of moves
+ *
+ * returns:
+ *	pointer to the first of its entries (0 - there are none)
+ */
+static struct bentry *b_find( hash_t key, int *np )
+{	register int lo, hi, mid;
+
+	lo = 0;
+	hi = b_book->b_nentries;
+	while( lo < hi )
+	{	mid = (lo + hi) / 2;
+		if (b_entries[mid].b_key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for( hi = lo; hi < b_book->b_nentries  &&  b_entries[hi].b_key == key; hi++ );
+	*np = hi - lo;
+	return( hi > lo ? &b_entries[lo] : 0 );
+}
+
+/*
+ * routine:
+ *	b_choose
+ *
+ * purpose:
+ *	to choose among the moves for a position
+ *
+ * parms:
+ *	the position's entries
+ *	number of them
+ *
+ * returns:
+ *	the chosen entry
+ *	0 - none is good enough
+ *
+ * note:
+ *	the move played most often is chosen, so long as it was played in
+ *	at least B_MINGAMES games and won at least B_MINRATE percent of
+ *	them (counting one more win and one more loss, so that a few lucky
+ *	games don't count for too much).
+ */
+static struct bentry *b_choose( struct bentry *ep, int n )
+{	register struct bentry *bp;
+	struct bentry *best = 0;
+
+	for( bp = ep; bp < ep + n; bp++ )
+	{	if (bp->b_played < B_MINGAMES  ||
+			100 * (bp->b_wins + 1) < B_MINRATE * (bp->b_played + 2))
+			continue;
+		if (best == 0  ||  bp->b_played > best->b_played  ||
+			(bp->b_played == best->b_played  &&  bp->b_wins > best->b_wins))
+			best = bp;
+	}
+	return( best );
+}
+
+/*
+ * routine:
+ *	b_reply
+ *
+ * purpose:
+ *	to find the book move for the player to move
+ *
+ * parms:
+ *	game in which the move would be made
+ *
+ * returns:
+ *	point of the move
+ *	0 - there is none (or it is past time for the book)
+ */
+int b_reply( struct game_ctx *gp )
+{	register int s;
+	struct bentry *ep;
+	hash_t hashes[8], key;
+	int n;
+
+	if (b_entries == 0  ||  b_book->b_size != gp->g_size  ||
+		gp->g_movenum > b_limit)
+		return( 0 );
+
+	key = b_hash( gp, gp->g_nxtcolor, hashes );
+	if ((ep = b_find( key, &n )) == 0  ||  (ep = b_choose( ep, n )) == 0)
+		return( 0 );
+
+	/* turn the move back the way the board was turned */
+	for( s = 0; hashes[s] != key; s++ );
+	return( b_unturn( ep->b_move, s, gp->g_size ) );
+}
+
+/*
+ * routine:
+ *	b_add
+ *
+ * purpose:
+ *	to add an entry to the book being built
+ *
+ * parms:
+ *	canonical hash of the position
+ *	point of the move (turned)
+ *	color of the player who made it
+ *
+ * returns:
+ *	TRUE	it was added
+ *	FALSE	there is no room
+ *
+ * note:
+ *	until the game is over, b_wins notes who made the move
+ */
+static int b_add( hash_t key, int move, int color )
+{	register struct bentry *bp;
+	int n;
+
+	if (b_nbuilt >= b_maxbuilt)
+	{	n = b_maxbuilt ? 2 * b_maxbuilt : 4096;
+		bp = (struct bentry *) realloc( (char *) b_built, n * sizeof (struct bentry) );
+		if (bp == 0)
+			return( FALSE );
+		b_built = bp;
+		b_maxbuilt = n;
+	}
+
+	bp = &b_built[ b_nbuilt++ ];
+	(void) memset( (char *) bp, 0, sizeof *bp );
+	bp->b_key = key;
+	bp->b_move = move;
+	bp->b_played = 1;
+	bp->b_wins = color;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	b_game
+ *
+ * purpose:
+ *	to add the early moves of a game to the book being built
+ *
+ * parms:
+ *	game record
+ *	number of moves to be added
+ *
+ * returns:
+ *	TRUE	the game was added
+ *	FALSE	it was not (it is on a board of another size, or there was
+ *		no room)
+ *
+ * note:
+ *	the game is replayed to the end (as far as its moves are legal) to
+ *	see who won it.  Since a saved game is not always finished, it is
+ *	played out B_PLAYOUTS times from there, and whoever wins most of
+ *	them (counting komi) is taken to have won.
+ */
+static int b_game( struct record *rp, int depth )
+{	register int i;
+	struct game_ctx *lp;
+	hash_t hashes[8], key;
+	unsigned long seed = 1;
+	int first, wwins, winner;
+
+	if ((lp = g_new( rp->r_size )) == 0)
+		return( FALSE );
+	lp->g_engine = lp->g_engine->e_light;
+
+	first = b_nbuilt;
+	for( i = 0; i < rp->r_nmoves; i++ )
+	{	if (i < depth  &&  rp->r_point[i])
+		{	key = b_hash( lp, rp->r_color[i], hashes );
+			if (!b_add( key, b_canon( rp->r_point[i], hashes, key,
+					lp->g_size ), rp->r_color[i] ))
+			{	b_nbuilt = first;
+				g_free( lp );
+				return( FALSE );
+			}
+		}
+
+		lp->g_nxtcolor = rp->r_color[i];
+		if (!p_make( lp, rp->r_point[i] ))
+			break;
+	}
+
+	for( wwins = i = 0; i < B_PLAYOUTS; i++ )
+		if (p_playout( lp, &seed ) > komi)
+			wwins++;
+	winner = (2 * wwins > B_PLAYOUTS) ? WHITE : BLACK;
+	g_free( lp );
+
+	for( i = first; i < b_nbuilt; i++ )
+		b_built[i].b_wins = b_built[i].b_wins == winner;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	b_compare
+ *
+ * purpose:
+ *	to order book entries by position, and then by move (for qsort)
+ */
+static int b_compare( const void *a, const void *b )
+{	register const struct bentry *ap = (const struct bentry *) a;
+	register const struct bentry *bp = (const struct bentry *) b;
+
+	if (ap->b_key != bp->b_key)
+		return( ap->b_key < bp->b_key ? -1 : 1 );
+	return( ap->b_move - bp->b_move );
+}
+
+/*
+ * routine:
+ *	b_build
+ *
+ * purpose:
+ *	to build a book from the saved games in a directory
+ *
+ * parms:
+ *	name of the directory (all of its .sav files are read)
+ *	name of the book file to be written
+ *	number of moves of each game to be put in the book
+ *
+ * returns:
+ *	number of games in the book
+ *	-1 - it could not be built
+ *
+ * note:
+ *	all of the games must be on boards of the same size (that of the
+ *	first one read), and others are left out.  Once the entries are
+ *	sorted, those for the same move in the same position are merged.
+ */
+int b_build( char *dir, char *file, int depth )
+{	register struct bentry *bp, *ep;
+	register int n;
+	struct dirent *dp;
+	struct record *rp;
+	struct bheader hdr;
+	char name[ 1024 ];
+	FILE *outfile;
+	DIR *dirp;
+	int size = 0, games = 0;
+
+	if ((dirp = opendir( dir )) == NULL)
+	{	d_msg( "Unable to read directory: %s", dir );
+		return( -1 );
+	}
+	if ((rp = (struct record *) malloc( sizeof (struct record) )) == 0)
+	{	d_msg( "Unable to allocate a game record" );
+		(void) closedir( dirp );
+		return( -1 );
+	}
+
+	b_nbuilt = 0;
+	while( (dp = readdir( dirp )) != NULL )
+	{	n = strlen( dp->d_name );
+		if (n < 5  ||  strcmp( &dp->d_name[n-4], ".sav" ) != 0  ||
+			strlen( dir ) + n + 2 > sizeof name)
+			continue;
+		(void) sprintf( name, "%s/%s", dir, dp->d_name );
+		if (a_record( name, rp ) <= 0)
+			continue;
+		if (size == 0)
+			size = rp->r_size;
+		if (rp->r_size == size  &&  b_game( rp, depth ))
+			games++;
+	}
+	(void) closedir( dirp );
+	free( (char *) rp );
+
+	if (games == 0)
+	{	d_msg( "No games found in %s", dir );
+		return( -1 );
+	}
+
+	/* sort the entries, and merge those for the same move */
+	qsort( (char *) b_built, b_nbuilt, sizeof (struct bentry), b_compare );
+	for( bp = ep = b_built; ep < b_built + b_nbuilt; ep++ )
+		if (ep > b_built  &&  ep->b_key == bp->b_key  &&  ep->b_move == bp->b_move)
+		{	bp->b_played += ep->b_played;
+			bp->b_wins += ep->b_wins;
+		} else if (ep > b_built)
+			*++bp = *ep;
+	n = b_nbuilt ? bp - b_built + 1 : 0;
+
+	(void) memset( (char *) &hdr, 0, sizeof hdr );
+	(void) memcpy( hdr.b_magic, B_MAGIC, sizeof hdr.b_magic );
+	hdr.b_size = size;
+	hdr.b_depth = depth;
+	hdr.b_nentries = n;
+	hdr.b_ngames = games;
+	if ((outfile = fopen( file, "w" )) != NULL)
+	{	(void) fwrite( (char *) &hdr, sizeof hdr, 1, outfile );
+		(void) fwrite( (char *) b_built, sizeof (struct bentry), n, outfile );
+	}
+
+	free( (char *) b_built );
+	b_built = 0;
+	b_nbuilt = b_maxbuilt = 0;
+
+	if (outfile == NULL)
+	{	d_msg( "Unable to create book file: %s", file );
+		return( -1 );
+	}
+	if (fclose( outfile ) != 0)
+	{	d_msg( "Unable to write book file: %s", file );
+		return( -1 );
+	}
+	return( games );
+}
+
+/*
+ * routine:
+ *	b_show
+ *
+ * purpose:
+ *	to display the book moves for the player to move (the k command),
+ *	with the number of games each was played in
+ *
+ * parms:
+ *	game to be displayed
+ *
+ * note:
+ *	the move the computer would choose is shown as special
+ */
+void b_show( struct game_ctx *gp )
+{	register struct bentry *bp;
+	struct bentry *ep, *best;
+	hash_t hashes[8], key;
+	int n, s, pt;
+
+	if (b_entries == 0  ||  b_book->b_size != gp->g_size)
+	{	d_msg( "No opening book for a %d line board", gp->g_size );
+		return;
+	}
+
+	key = b_hash( gp, gp->g_nxtcolor, hashes );
+	if ((ep = b_find( key, &n )) == 0)
+	{	d_msg( "This position is not in the book" );
+		return;
+	}
+	best = b_choose( ep, n );
+	for( s = 0; hashes[s] != key; s++ );
+
+	for( bp = ep; bp < ep + n; bp++ )
+	{	pt = b_unturn( bp->b_move, s, gp->g_size );
+		d_value( P_ROW( pt ), P_COL( pt ), gp->g_nxtcolor,
+			bp == best ? B_SPECIAL : B_ARMY, bp->b_played );
+	}
+	d_update();
+	if (best)
+		d_msg( "%d book moves here, the best won %d of %d games",
+			n, best->b_wins, best->b_played );
+	else
+		d_msg( "%d book moves here, none played often enough", n );
+}
+
+/*
+ * routine:
+ *	c_book
+ *
+ * purpose:
+ *	to build, use and display opening books (the k command)
+ *
+ * parms:
+ *	argument string
+ *		(none)		show the book moves in this position
+ *		b <dir> <file>	build a book from the saved games in a
+ *				directory, and use it
+ *		r <file>	use a book
+ *		n #		use the book for the first # moves of a
+ *				game (and put that many in books built)
+ *		c		stop using the book
+ *	files default to B_DEFFILE
+ */
+void c_book( char *arg )
+{	register char *s, *e;
+	char dir[ MAXLINE ];
+	int n;
+
+	s_ponder( cur_game, FALSE );
+
+	if (arg == 0  ||  *arg == 0)
+	{	b_show( cur_game );
+		(void) confirm( "enter return to resume game" );
+		b_redraw( cur_game, FALSE );
+		return;
+	}
+
+	/* find the argument(s), if any */
+	for( s = arg; *s && *s != ' ' && *s != '\t'; s++ );
+	while( *s == ' ' || *s == '\t' )
+		s++;
+
+	switch( *arg )
+	{ case 'b':	/* build a book */
+		for( e = s; *e && *e != ' ' && *e != '\t'; e++ );
+		(void) sprintf( dir, "%.*s", (int) (e - s), s );
+		while( *e == ' ' || *e == '\t' )
+			e++;
+		if (*e == 0)
+			e = B_DEFFILE;
+		if (dir[0] == 0)
+		{	d_msg( "Which directory are the games in?" );
+			break;
+		}
+		if ((n = b_build( dir, e, b_limit )) >= 0  &&  b_open( e, TRUE ) >= 0)
+			d_msg( "Book of %d games, %d moves, written to %s",
+				n, b_book->b_nentries, e );
+		break;
+
+	  case 'r':	/* use a book */
+		if (*s == 0)
+			s = B_DEFFILE;
+		if ((n = b_open( s, TRUE )) >= 0)
+			d_msg( "Book of %d games, %d moves, read from %s",
+				b_book->b_ngames, n, s );
+		break;
+
+	  case 'n':	/* number of moves to use it for */
+		if (*s)
+			b_limit = atoi( s );
+		d_msg( "The book is used for the first %d moves", b_limit );
+		break;
+
+	  case 'c':	/* stop using it */
+		b_close();
+		d_msg( "No opening book is in use" );
+		break;
+
+	  default:
+		d_msg( "Unrecognized book request: %s", arg );
+		break;
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ * module:
+ *	book.h
+ *
+ * purpose:
+ *	to describe the opening book: the moves played in the early
+ *	positions of a collection of games, and how well they did
+ */
+
+/*
+ * A position in the book is known by its canonical hash.  The hash of
+ * a position is the exclusive-or of the keys (see zobrist.h) for its
+ * stones, and of a key for white being the one to move.  Rotating or
+ * reflecting the board (eight ways) gives up to eight hashes for the
+ * same position; the least of them is the canonical one.  Moves are
+ * kept as points of the board turned the way that gave the canonical
+ * hash (and, if the position looks the same turned more than one way,
+ * as the least of the points the move could be turned to), so a move
+ * played in any of the turnings of a position is the same move.
+ *
+ * The book file is a header, and then an entry for each move played in
+ * each position, sorted by the hash of the position and then by the
+ * move, so the moves for a position are together and can be found by
+ * searching the entries by halves.  Each entry counts the games in
+ * which the move was played there, and the games the player who made
+ * it went on to win.  The file is mapped into memory (read only, and
+ * shared with any other process that maps it) and used where it lies.
+ * It is in the byte order of the machine that built it.
+ */
+#define B_DEPTH		20	/* moves of a game the book is for */
+#define B_MINGAMES	2	/* games a move must have been played in */
+#define B_MINRATE	35	/* percent of them it must have won */
+#define B_PLAYOUTS	32	/* playouts to decide who won an unfinished game */
+#define B_DEFFILE	"go.bok" /* book mapped when the program starts */
+#define B_MAGIC		"GOBOOK01"
+
+/* key for white being the one to move (point 0 never holds a stone) */
+#define B_WHITEKEY	Z_STONE( WHITE, 0 )
+
+/* the book file: a header, and then the entries */
+struct bheader
+{	char	b_magic[8];	/* B_MAGIC */
+	int	b_size;		/* size of the board the games were played on */
+	int	b_depth;	/* moves of each game put in the book */
+	int	b_nentries;	/* number of entries */
+	int	b_ngames;	/* number of games it was built from */
+};
+
+struct bentry
+{	hash_t	b_key;		/* canonical hash of the position */
+	int	b_move;		/* point of the move (turned, as above) */
+	int	b_played;	/* games in which it was played there */
+	int	b_wins;		/* games the player who made it won */
+	int	b_unused;
+};
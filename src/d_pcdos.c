@@ -14,24 +14,32 @@
 #include "go.h"
 #include "disp.h"
 
-/* screen layout parameters - based 25 line screen and a max 19 line board */
+/*
+ * screen layout parameters - based 25 line screen and a max 19 line board.
+ * Larger boards are shown only in part: the points beyond the 19th row
+ * or column are simply not drawn (they can still be played).
+ */
+#define SCRBOARD  19				/* most lines we can show */
+#define SHOWN	  (boardsize < SCRBOARD ? boardsize : SCRBOARD)
+#define OFFSCREEN(r,c)	((r) > SCRBOARD || (c) > SCRBOARD)
+
 #define HEADLINE  0				/* line for herald/score info */
 #define HISTLINE  1				/* line where history starts */
 #define BOARDLINE 2				/* line where board begins */
-#define MSGLINE	  (BOARDLINE+MAXBOARD+2)	/* line for messages */
+#define MSGLINE	  (BOARDLINE+SCRBOARD+2)	/* line for messages */
 #define PRMLINE	  (MSGLINE+1)			/* line for input prompts */
 #define LASTLINE  25				/* last line on screen */
 
 #define POINT_WID 3				/* width of a point on board */
-#define FREECOL	  (POINT_WID*(MAXBOARD+2))	/* first column beyond board */
+#define FREECOL	  (POINT_WID*(SCRBOARD+2))	/* first column beyond board */
 #define HISTCOL   (FREECOL+2)			/* colum for move history */
 #define LASTCOL	  80				/* width of a screen */
 #define HISTLEN	  (MSGLINE-HISTLINE)		/* lines for move history */
 		
 /* board to screen mapping macros */
-#define boardrow(r) (unsigned)(BOARDLINE+MAXBOARD-(r))
+#define boardrow(r) (unsigned)(BOARDLINE+SCRBOARD-(r))
 #define boardcol(c) (unsigned)(POINT_WID*(c))
-#define UNROW(y)	(BOARDLINE+MAXBOARD-y)
+#define UNROW(y)	(BOARDLINE+SCRBOARD-y)
 #define UNCOL(x)	((x - POINT_WID) / POINT_WID)
 
 /* imported and exported parameters */
@@ -818,7 +826,7 @@ int d_readline( char *buf )
 			{	buf[lastcol++] = ' ';
 				buf[lastcol++] = '0' + UNROW( cur_row )/10;
 				buf[lastcol++] = '0' + UNROW( cur_row )%10;
-				buf[lastcol++] = 'a' + UNCOL( cur_col );
+				buf[lastcol++] = COLNAME( 1 + UNCOL( cur_col ) );
 				buf[lastcol] = 0;
 				pc_d_line( PRMLINE, offset, buf );
 			} else
@@ -878,13 +886,13 @@ int d_readline( char *buf )
 		 * are all around the cursor pad.
 		 */
 		case C_c_ul:	/* home to upper-left of board */
-			cur_row = boardrow( boardsize-3 );
+			cur_row = boardrow( SHOWN-3 );
 			cur_col = boardcol( 4 )+1;
 			goto movecur;
 
 		case C_c_ur:	/* home to upper-right of board */
-			cur_row = boardrow( boardsize-3 );
-			cur_col = boardcol( boardsize-3 )+1;
+			cur_row = boardrow( SHOWN-3 );
+			cur_col = boardcol( SHOWN-3 )+1;
 			goto movecur;
 
 		case C_c_ll:	/* home to lower-left of board */
@@ -894,20 +902,20 @@ int d_readline( char *buf )
 
 		case C_c_lr:	/* home to lower-right of board */
 			cur_row = boardrow( 4 );
-			cur_col = boardcol( boardsize-3 )+1;
+			cur_col = boardcol( SHOWN-3 )+1;
 			goto movecur;
 
 		/*
 		 * relative cursor motion commands
 		 */
 		case C_c_up:	/* cursor up one row */
-			if (--cur_row < boardrow( boardsize ))
+			if (--cur_row < boardrow( SHOWN ))
 				cur_row = boardrow( 1 );
 			goto movecur;
 
 		case C_c_dn:	/* cursor down one row */
 			if (++cur_row > boardrow( 1 ))
-				cur_row = boardrow( boardsize );
+				cur_row = boardrow( SHOWN );
 			goto movecur;
 
 		case C_c_rt:	/* cursor right one column */
@@ -916,7 +924,7 @@ int d_readline( char *buf )
 			{	if (cur_col >= lastcol)
 					cur_col = offset;
 			} else
-			{	if (cur_col > (boardcol( boardsize )+1))
+			{	if (cur_col > (boardcol( SHOWN )+1))
 					cur_col = boardcol(1) + 1;
 			}
 			goto movecur;
@@ -928,14 +936,14 @@ int d_readline( char *buf )
 					cur_col = lastcol+offset;
 			} else
 			{	if (cur_col <= boardcol( 1 ))
-					cur_col = boardcol( boardsize ) + 1;
+					cur_col = boardcol( SHOWN ) + 1;
 			}
 			goto movecur;
 
 		 default: /* all other control functions toggle board/line */ 
 			if (cur_row == PRMLINE)
-			{	cur_row = boardrow( (boardsize+1)/2 );
-				cur_col = boardcol( (boardsize+1)/2 ) + 1;
+			{	cur_row = boardrow( (SHOWN+1)/2 );
+				cur_col = boardcol( (SHOWN+1)/2 ) + 1;
 			} else
 			{	cur_row = PRMLINE;
 				cur_col = offset + lastcol;
@@ -1040,21 +1048,21 @@ void d_clear()
 	pc_d_line( HEADLINE, 0, header );
 
 	/* label the horizontal axes */
-	for( i = 1; i <= boardsize; i++ )
-	{	pc_d_char( boardrow(0), boardcol(i)+1, 'a'+i-1, atrs, 1 );
-		pc_d_char( boardrow(boardsize+1),boardcol(i)+1,'a'+i-1,atrs,1 );
+	for( i = 1; i <= SHOWN; i++ )
+	{	pc_d_char( boardrow(0), boardcol(i)+1, COLNAME(i), atrs, 1 );
+		pc_d_char( boardrow(SHOWN+1),boardcol(i)+1,COLNAME(i),atrs,1 );
 	}
 
 	/* label the vertical axes */
-	for( i = 1; i <= boardsize; i++ )
+	for( i = 1; i <= SHOWN; i++ )
 	{	if (i >= 10)
 		{	pc_d_char( boardrow(i),boardcol(0),'0'+(i/10),atrs,1 );
-			pc_d_char( boardrow(i), boardcol(boardsize+1)+1, 
+			pc_d_char( boardrow(i), boardcol(SHOWN+1)+1, 
 				'0'+(i/10), atrs, 1 );
-			pc_d_char( boardrow(i), boardcol(boardsize+1)+2, 
+			pc_d_char( boardrow(i), boardcol(SHOWN+1)+2, 
 				'0'+(i%10), atrs, 1 );
 		} else
-		{	pc_d_char( boardrow(i), boardcol(boardsize+1)+1,
+		{	pc_d_char( boardrow(i), boardcol(SHOWN+1)+1,
 				'0'+i, atrs, 1 );
 		}
 		pc_d_char( boardrow(i), boardcol(0)+1, '0'+(i%10), atrs, 1 );
@@ -1080,6 +1088,9 @@ void d_clear()
 void d_blank( unsigned row, unsigned col, unsigned color, int shade )
 {	unsigned char atr, lsp, rsp;
 
+	if (OFFSCREEN( row, col ))
+		return;
+
 	/*
 	 * each point takes up three spaces on the screen, and what
 	 * we put in the spaces depends on where the point is
@@ -1118,6 +1129,9 @@ void d_stone( unsigned row, unsigned col, unsigned color, int shade, int num )
 	char lsp, rsp;
 	unsigned char atrs = ATTRIBUTE( shade, color );
 
+	if (OFFSCREEN( row, col ))
+		return;
+
 	/*
 	 * each point takes up three spaces on the screen, and what
 	 * we put in the spaces depends on where the point is
@@ -1164,6 +1178,9 @@ void d_value( unsigned row, unsigned col, unsigned color, int shade, int num )
 {	unsigned char lsp, rsp;
 	unsigned char atrs = ATTRIBUTE( shade, color );
 
+	if (OFFSCREEN( row, col ))
+		return;
+
 	/* start by writing out some appropriate white space */
 	lsp = (grafset && col > 1) ? C_bar : ' ';
 	rsp = (grafset && col < boardsize) ? C_bar : ' ';
@@ -7,11 +7,16 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "dbg.h"
 #include "go.h"
 #include "libs.h"
 #include "move.h"
 #include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "pattern.h"
 
 #define DBGLOG	"go.dbg"
 
@@ -99,56 +104,84 @@ static char *contin = "enter return to continue the audit";
  *	l_audit
  *
  * purpose:
- *	to audit the liberty lists and print the results
+ *	to audit the liberty sets and print the results
+ *
+ * parms:
+ *	game to be audited
  */
-void l_audit()
-{	register struct libs *lp;
-	register int loopcnt;
-	register int freecnt = 0;
-	register int foundcnt = 0;
-	register struct move *mp;
-	extern struct libs *freelibs;
-
-	/* count the free liberties */
-	for( lp = freelibs, loopcnt = 0; lp; lp = lp->l_next )
-	{	freecnt++;
-		if (loopcnt++ > MAXLIBS)
-		{	d_msg( "LIBERTY ERROR: LOOP IN FREE LIST" );
-			(void) confirm( contin );
-			break;
-		}
-	}
+void l_audit( struct game_ctx *gp )
+{	register struct move *mp;
+	register int i, count;
+	int sets = 0;
+	int libs = 0;
+	int m;
 
-	/* tally up the liberties associated with each move */
-	for( mp = moves; mp < &moves[ MAXMOVE ]; mp++ )
-	{	loopcnt = 0;
-		/* count liberties in this move, checking for loops */
-		for( lp = mp->m_liblist; lp; lp = lp->l_next )
-		{	foundcnt++;
-			if (loopcnt++ > MAXLIBS)
-			{	d_msg( "LIBERTY ERROR: loop in move %d", 
-					mp-moves );
-				(void) confirm( contin );
-				break;
-			}
-		}
+	/* make sure each set agrees with its move's liberty count */
+	for( m = 0; m < gp->g_movehigh; m++ )
+	{	mp = MOVE( gp, m );
+		if (mp->m_libset == 0)
+			continue;
+		sets++;
 
-		/* make sure the list length agrees with the liberty count */
-		if ((loopcnt != mp->m_libs)  &&  
-			( (mp > &moves[ pillage ])  ||  (loopcnt != 0)) )
-		{	d_msg( "LIBERTY ERROR: move %d, count %d, list %d",
-				mp-moves, mp->m_libs, loopcnt );
+		for( count = 0, i = 0; i < gp->g_libwords; i++ )
+			count += L_COUNT( mp->m_libset[i] );
+		libs += count;
+
+		if (count != mp->m_libs)
+		{	d_msg( "LIBERTY ERROR: move %d, count %d, set %d",
+				mp->m_num, mp->m_libs, count );
 			(void) confirm( contin );
 		}
 	}
 
 	/* report on results */
-	d_msg( "LIBERTIES: %d free, %d in use, total %d, lost %d, pillage %d",
-		freecnt, foundcnt, freecnt+foundcnt, MAXLIBS-(freecnt+foundcnt),
-		pillage );
+	d_msg( "LIBERTIES: %d sets of %d words, %d libs, high water %d, %d chunks",
+		sets, gp->g_libwords, libs, gp->g_libhigh, gp->g_nchunks );
+	(void) confirm( contin );
+	d_msg( "MOVES: %d entries in use, %d chunks of %d, %s engine",
+		gp->g_movehigh, gp->g_nmchunks, MOVECHUNK,
+		gp->g_engine->e_name );
 	(void) confirm( contin );
 }
 
+/*
+ * routine:
+ *	m_ring
+ *
+ * purpose:
+ *	to count the stones in the ring of a string on the board
+ *
+ * parms:
+ *	game in which the string is found
+ *	move number of the string
+ *
+ * returns:
+ *	number of stones in the ring (all of which should bear that number)
+ *
+ * note:
+ *	a ring that has been broken will never lead back to its start,
+ *	so we give up after visiting every point on the board.
+ */
+static int m_ring( struct game_ctx *gp, int m )
+{	register struct string *sp;
+	int pt, start;
+	int count = 0;
+
+	pt = start = MOVE( gp, m )->m_point;
+	do
+	{	sp = &gp->g_str[pt];
+		if (sp->s_moveno != m)
+		{	d_msg( "MOVE ERROR: %d ring strays to %c%d", m,
+				COLNAME( P_COL( pt ) ), P_ROW( pt ) );
+			(void) confirm( contin );
+			break;
+		}
+		pt = sp->s_next;
+	} while( ++count <= gp->g_size * gp->g_size  &&  pt != start );
+
+	return( count );
+}
+
 /*
  * routine:
  *	m_audit
@@ -165,21 +198,29 @@ void l_audit()
  *	determination is only possible when the move in question is at the
  *	top of the move stack.
  */
-void m_audit()
+void m_audit( struct game_ctx *gp )
 {	register struct move *mp;
 	register short *np;
-	int stones, hurts, m;
-	char absbd[MAXMOVE];	/* how many times is this move absorbed */
-	char hurt[MAXMOVE];	/* how many times is this move hurt */
+	int stones, hurts, i, m, r;
+	char *absbd;		/* how many times is this move absorbed */
+	char *hurt;		/* how many times is this move hurt */
+
+	absbd = (char *) malloc( 2 * gp->g_movenum );
+	if (absbd == 0)
+	{	d_msg( "Unable to allocate space for the move audit" );
+		return;
+	}
+	hurt = &absbd[ gp->g_movenum ];
 
 	/* look at each move structure and establish the connectivity */
-	for( mp = &moves[1]; mp < &moves[ movenum ]; mp++ )
-	{	absbd[ mp - moves ] =hurt[ mp - moves ] = hurts = 0;
+	for( i = 1; i < gp->g_movenum; i++ )
+	{	mp = MOVE( gp, i );
+		absbd[ mp->m_num ] = hurt[ mp->m_num ] = hurts = 0;
 		stones = 1;
 
 		/* see whether or not this is a real move */
 		if (mp->m_pos.row_col == 0)
-		{	absbd[ mp - moves ] = 1; /* not really, but sort of */
+		{	absbd[ mp->m_num ] = 1; /* not really, but sort of */
 			stones = 0;
 		}
 
@@ -189,16 +230,16 @@ void m_audit()
 			if ((m = *np) == 0)
 				continue;
 			if (m > 0)	/* subsumed */
-			{	stones += moves[ m ].m_stones;
+			{	stones += MOVE( gp, m )->m_stones;
 				absbd[m]++;
 			} else
 			{	hurts++;
 				m *= -1;
 				hurt[m]++;
 			}
-			if (m >= (mp - moves))
+			if (m >= mp->m_num)
 			{	d_msg( "MOVE ERROR: %d refers to %d",
-					mp-moves, m );
+					mp->m_num, m );
 				(void) confirm( contin );
 			}
 		}
@@ -206,21 +247,20 @@ void m_audit()
 		/* compare our counts with recorded counts */
 		if (stones != mp->m_stones)
 		{	d_msg( "MOVE ERROR: %d - m_stones %d, counted %d",
-				mp-moves, mp->m_stones, stones );
+				mp->m_num, mp->m_stones, stones );
 			(void) confirm( contin );
 		}
 
 		if (hurts != mp->m_hurts)
 		{	d_msg( "MOVE ERROR: %d - m_hurts %d, counted %d",
-				mp-moves, mp->m_hurts, hurts );
+				mp->m_num, mp->m_hurts, hurts );
 			(void) confirm( contin );
 		}
 	}
 
-#define ROW(n)	moves[n].m_pos.sub.row
-#define COL(n)	moves[n].m_pos.sub.col
+#define POINT(n)	MOVE( gp, n )->m_point
 	/* confirm that all moves are properly subsumed or on string board */
-	for( m = 1; m < movenum; m++ )
+	for( m = 1; m < gp->g_movenum; m++ )
 	{	/* no move should be multiply absorbed */	
 		if (absbd[m] > 1)
 		{	d_msg( "MOVE ERROR: %d referenced %dx", m, absbd[m] );
@@ -230,7 +270,7 @@ void m_audit()
 
 		/* absorbed moves shouldn't be on the board */
 		if (absbd[m] == 1)
-		{	if (str_board[ ROW(m) ][ COL(m) ].s_moveno == m)
+		{	if (gp->g_str[ POINT(m) ].s_moveno == m)
 			{	d_msg( "MOVE ERROR: %d still on board", m );
 				(void) confirm( contin );
 			}
@@ -238,20 +278,233 @@ void m_audit()
 		}
 
 		/* not absorbed - should be dead or on string board */
-		if (str_board[ ROW(m) ][ COL(m) ].s_moveno != m)
+		if (gp->g_str[ POINT(m) ].s_moveno != m)
 		{	/* move is not on string board - dead ? */
-			if (hurt[m] > 0 && moves[m].m_libs == 0)
+			if (hurt[m] > 0 && MOVE( gp, m )->m_libs == 0)
 				continue;
 			d_msg( "MOVE ERROR: %d not referenced", m );
 			(void) confirm( contin );
 		} else
-		{	/* move is on string board */
-			if (moves[m].m_libs > 0)
+		{	/* move is on string board - its ring should hold it all */
+			r = m_ring( gp, m );
+			if (r != MOVE( gp, m )->m_stones)
+			{	d_msg( "MOVE ERROR: %d - m_stones %d, ring %d",
+					m, MOVE( gp, m )->m_stones, r );
+				(void) confirm( contin );
+			}
+			if (MOVE( gp, m )->m_libs > 0)
 				continue;
 			d_msg( "MOVE ERROR: %d appears dead", m );
 			(void) confirm( contin );
 		}
 	}
-#undef	ROW
-#undef	COL
+#undef	POINT
+
+	free( absbd );
+}
+
+/*
+ * routine:
+ *	e_audit
+ *
+ * purpose:
+ *	to check the regions of vacant points against the string board
+ *
+ * note:
+ *	each region is searched out afresh, and its points, size and
+ *	counts compared with what the engine has kept.
+ */
+void e_audit( struct game_ctx *gp )
+{	register struct region *rp;
+	register int pt, q, i;
+	int r, n, k, nfound, regions, touch[2];
+	char *seen, *used;
+	short *found;
+
+	seen = (char *) malloc( P_POINTS + E_MAXREGIONS );
+	found = (short *) malloc( P_POINTS * sizeof (short) );
+	if (seen == 0  ||  found == 0)
+	{	d_msg( "Unable to allocate space for the region audit" );
+		if (seen)
+			free( seen );
+		return;
+	}
+	used = &seen[ P_POINTS ];
+	for( pt = 0; pt < P_POINTS + E_MAXREGIONS; pt++ )
+		seen[pt] = 0;
+
+	regions = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	if (gp->g_str[pt].s_moveno != 0  ||  seen[pt])
+				continue;
+
+			/* search out the region around this point */
+			seen[pt] = 1;
+			found[0] = pt;
+			touch[BLACK] = touch[WHITE] = 0;
+			for( k = 0, nfound = 1; k < nfound; k++ )
+				for( i = 0; i < 4; i++ )
+				{	q = found[k] + p_adj[i];
+					if (gp->g_str[q].s_moveno > 0)
+						touch[ (int) gp->g_str[q].s_color ]++;
+					else if (gp->g_str[q].s_moveno == 0  &&  !seen[q])
+					{	seen[q] = 1;
+						found[ nfound++ ] = q;
+					}
+				}
+
+			/* all of its points should be in one region of their own */
+			n = gp->g_rgn[pt];
+			if (used[n]++)
+			{	d_msg( "REGION ERROR: region %d at %c%d is used twice",
+					n, COLNAME( P_COL( pt ) ), P_ROW( pt ) );
+				(void) confirm( contin );
+			}
+			regions++;
+			for( k = 0; k < nfound; k++ )
+				if (gp->g_rgn[ found[k] ] != n)
+				{	d_msg( "REGION ERROR: %c%d is in region %d, not %d",
+						COLNAME( P_COL( found[k] ) ),
+						P_ROW( found[k] ), gp->g_rgn[ found[k] ], n );
+					(void) confirm( contin );
+					break;
+				}
+
+			/* and its ring should hold just those points */
+			rp = &gp->g_region[n];
+			k = 0;
+			q = rp->e_point;
+			do
+			{	if (gp->g_rgn[q] != n  ||  gp->g_str[q].s_moveno != 0  ||
+					gp->g_rprev[ gp->g_rnext[q] ] != q)
+				{	d_msg( "REGION ERROR: region %d ring strays to %c%d",
+						n, COLNAME( P_COL( q ) ), P_ROW( q ) );
+					(void) confirm( contin );
+					break;
+				}
+				q = gp->g_rnext[q];
+			} while( ++k <= nfound  &&  q != rp->e_point );
+
+			if (rp->e_size != nfound  ||  k != nfound  ||
+				rp->e_touch[BLACK] != touch[BLACK]  ||
+				rp->e_touch[WHITE] != touch[WHITE])
+			{	d_msg( "REGION ERROR: region %d at %c%d - size %d/%d, ring %d, touch %d/%d %d/%d",
+					n, COLNAME( P_COL( pt ) ), P_ROW( pt ),
+					rp->e_size, nfound, k, rp->e_touch[BLACK],
+					touch[BLACK], rp->e_touch[WHITE], touch[WHITE] );
+				(void) confirm( contin );
+			}
+		}
+
+	if (regions + gp->g_nrfree != E_MAXREGIONS)
+	{	d_msg( "REGION ERROR: %d regions, %d free", regions, gp->g_nrfree );
+		(void) confirm( contin );
+	}
+
+	free( seen );
+	free( (char *) found );
+}
+
+/*
+ * routine:
+ *	x_audit
+ *
+ * purpose:
+ *	to check the pattern codes against the string board
+ */
+void x_audit( struct game_ctx *gp )
+{	register int pt, r;
+	unsigned long code;
+
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	code = x_code( gp, pt );
+			if (gp->g_pat[pt] != code)
+			{	d_msg( "PATTERN ERROR: %c%d is %04lx, not %04lx",
+					COLNAME( P_COL( pt ) ), P_ROW( pt ),
+					gp->g_pat[pt], code );
+				(void) confirm( contin );
+			}
+		}
+}
+
+/*
+ * routine:
+ *	q_audit
+ *
+ * purpose:
+ *	to check the large pattern hashes (if the game keeps them) against
+ *	hashes worked out from scratch
+ */
+void q_audit( struct game_ctx *gp )
+{	register int pt, r;
+	struct qpoint *qp;
+
+	if (gp->g_qpat == 0)
+		return;
+
+	qp = (struct qpoint *) malloc( P_POINTS * sizeof (struct qpoint) );
+	if (qp == 0)
+	{	d_msg( "Unable to allocate space for the pattern hash audit" );
+		return;
+	}
+	q_build( gp, qp );
+
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if (memcmp( (char *) &qp[pt], (char *) &gp->g_qpat[pt],
+					sizeof (struct qpoint) ) != 0)
+			{	d_msg( "PATTERN HASH ERROR: %c%d",
+					COLNAME( P_COL( pt ) ), P_ROW( pt ) );
+				(void) confirm( contin );
+			}
+
+	free( (char *) qp );
+}
+
+/*
+ * routine:
+ *	c_debug
+ *
+ * purpose:
+ *	to perform the diagnostic (D) command
+ *
+ * parms:
+ *	command string
+ *	    a	 - audit the liberty lists, move structures, regions,
+ *		   pattern codes and pattern hashes
+ *	    s #	 - time a number of playouts from the current position
+ *	    h	 - report on the use of the transposition (hash) table
+ *	    +xxx - turn on the specified traces (see dbgstat)
+ *	    -xxx - turn off the specified traces
+ *	    null - display current debug status
+ */
+void c_debug( char *arg )
+{
+	if (arg == 0  ||  *arg == '+'  ||  *arg == '-')
+	{	dbgstat( arg );
+		return;
+	}
+
+	switch( *arg )
+	{ case 'a':	/* audit the corruptable resources */
+		l_audit( cur_game );
+		m_audit( cur_game );
+		e_audit( cur_game );
+		x_audit( cur_game );
+		q_audit( cur_game );
+		break;
+
+	  case 's':	/* speed check, with playouts */
+		p_speed( cur_game, atoi( arg+1 ) );
+		break;
+
+	  case 'h':	/* transposition table statistics */
+		t_show();
+		break;
+
+	  default:
+		d_msg( "Unrecognized diagnostic request: %s", arg );
+	}
 }
@@ -11,9 +11,9 @@ int debug;	/* word of debug flags */
 
 /* 
  * TRACING macro is used to determine whether or not a particular
- * 	type of event is being traced
+ * 	type of event is being traced in a particular game
  */
-#define TRACING(m)	((debug&(m)) ? (!fantasy) || (debug&D_fantasy) : 0)
+#define TRACING(gp,m)	((debug&(m)) ? (!(gp)->g_fantasy) || (debug&D_fantasy) : 0)
 
 /* bits for various debug options */
 #define	D_all		0xff		/* all debugging options */
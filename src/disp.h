@@ -14,12 +14,14 @@
  *	the move number that placed the stone there
  *	any special notations on the stone
  *	any special notations on the point
- * this information is used to generate the board display on the screen
+ * this information is used to generate the board display on the screen.
+ * The display board itself (g_dsp) is part of the game context, and is
+ * described in game.h.  Like the other boards, it is indexed by point
+ * number (see go.h), so its border points are simply never used.
  */
-unsigned short dsp_board[ MAXBOARD ][ MAXBOARD ];
-unsigned short b_set(), b_tag();
 
 /* fields of board structure */
+#define B_NUMSHIFT	16	/* move number is above all of the others */
 #define B_COLOR		0x8000	/* stone color indication   */
 
 #define B_SHADE		0x7000  /* background/rendition for stone display */
@@ -43,7 +45,8 @@ unsigned short b_set(), b_tag();
 
 /* macros to extract information from board */
 #define B_WHT_STONE(point)	((point)&B_COLOR)
-#define B_MOVENUM(point)	((point)&0x1ff)
+#define B_MOVENUM(point)	((int) ((point) >> B_NUMSHIFT))
+#define B_NUMBER(moveno)	((unsigned long) (moveno) << B_NUMSHIFT)
 
 /*
  * form of the display is determined by the value of b_display
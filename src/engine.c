@@ -0,0 +1,197 @@
+/*
+ * module:
+ *	engine.c
+ *
+ * purpose:
+ *	to build the move engines for the various board sizes, and to
+ *	choose the right one for a game
+ */
+#include <stdio.h>
+#include "go.h"
+#include "move.h"
+#include "dbg.h"
+#include "disp.h"
+#include "inf.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "zobrist.h"
+
+/* neighbor offsets, as compile time constants (see p_adj) */
+static const int k_adj[4] = P_ADJ;
+
+/* the eight points around a point, in order around it (see p_ring) */
+static const int k_ring[8] = P_RING;
+
+/* for each set of the eight points around a point that are not vacant
+ * (bit i for k_ring[i]), whether a stone there might cut its region
+ * apart: whether its vacant neighbors fall into more than one run of
+ * vacant points around it (filled in by k_init) */
+static char k_cuts[256];
+
+/*
+ * the general engines, for boards of any size
+ */
+#define K_SIZE(gp)	((gp)->g_size)
+#define K_WORDS(gp)	((gp)->g_libwords)
+#define K_FOLD(gp)	((gp)->g_fold)
+#define K_NAME(f)	f##_any
+#define K_LIGHT		0
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#define K_NAME(f)	f##_anyl
+#define K_LIGHT		1
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#undef K_SIZE
+#undef K_WORDS
+#undef K_FOLD
+
+/*
+ * the engines for particular sizes, each with its own copy of the
+ * influence folding function (see influenc.c)
+ */
+static int fold_9[] =
+{	0, 3, 2, 1,
+	1, 2, 3, 4, 5, 6, 7, 8, 9,
+	9, 8, 7
+};
+#define K_SIZE(gp)	9
+#define K_WORDS(gp)	L_WORDS( P_INDEX( 9, 9 ) + 1 )
+#define K_FOLD(gp)	fold_9
+#define K_NAME(f)	f##_9
+#define K_LIGHT		0
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#define K_NAME(f)	f##_9l
+#define K_LIGHT		1
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#undef K_SIZE
+#undef K_WORDS
+#undef K_FOLD
+
+static int fold_13[] =
+{	0, 3, 2, 1,
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+	13, 12, 11
+};
+#define K_SIZE(gp)	13
+#define K_WORDS(gp)	L_WORDS( P_INDEX( 13, 13 ) + 1 )
+#define K_FOLD(gp)	fold_13
+#define K_NAME(f)	f##_13
+#define K_LIGHT		0
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#define K_NAME(f)	f##_13l
+#define K_LIGHT		1
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#undef K_SIZE
+#undef K_WORDS
+#undef K_FOLD
+
+static int fold_19[] =
+{	0, 3, 2, 1,
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+	19, 18, 17
+};
+#define K_SIZE(gp)	19
+#define K_WORDS(gp)	L_WORDS( P_INDEX( 19, 19 ) + 1 )
+#define K_FOLD(gp)	fold_19
+#define K_NAME(f)	f##_19
+#define K_LIGHT		0
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#define K_NAME(f)	f##_19l
+#define K_LIGHT		1
+#include "kernel.c"
+#undef K_NAME
+#undef K_LIGHT
+#undef K_SIZE
+#undef K_WORDS
+#undef K_FOLD
+
+/*
+ * the tables of engines, each ending with the general one.  Every
+ * full engine knows the light engine for the same size of board.
+ */
+static struct engine lights[] =
+{	{ 9,	"9x9 light",	m_estimate_9l,	m_do_9l,   m_unmove_9l,   &lights[0] },
+	{ 13,	"13x13 light",	m_estimate_13l,	m_do_13l,  m_unmove_13l,  &lights[1] },
+	{ 19,	"19x19 light",	m_estimate_19l,	m_do_19l,  m_unmove_19l,  &lights[2] },
+	{ 0,	"general light",m_estimate_anyl,m_do_anyl, m_unmove_anyl, &lights[3] }
+};
+
+struct engine engines[] =
+{	{ 9,	"9x9",		m_estimate_9,	m_do_9,	   m_unmove_9,	  &lights[0] },
+	{ 13,	"13x13",	m_estimate_13,	m_do_13,   m_unmove_13,	  &lights[1] },
+	{ 19,	"19x19",	m_estimate_19,	m_do_19,   m_unmove_19,	  &lights[2] },
+	{ 0,	"general",	m_estimate_any,	m_do_any,  m_unmove_any,  &lights[3] }
+};
+
+/*
+ * routine:
+ *	k_init
+ *
+ * purpose:
+ *	to fill in the table of points that may cut a region (k_cuts)
+ */
+static void k_init( void )
+{	register int m, i, k, q;
+	int runs, orth;
+
+	for( m = 0; m < 256; m++ )
+	{	/* count the runs holding neighbors, from a point not vacant */
+		for( i = 0; i < 8  &&  !(m & 1 << i); i++ )
+			;
+		runs = orth = 0;
+		for( k = 1; i < 8  &&  k <= 8; k++ )
+		{	q = (i + k) & 7;
+			if (!(m & 1 << q))
+				orth |= !(q & 1);
+			else
+			{	runs += orth;
+				orth = 0;
+			}
+		}
+		k_cuts[m] = runs > 1;
+	}
+}
+
+/*
+ * routine:
+ *	e_select
+ *
+ * purpose:
+ *	to choose the engine for a board of a given size
+ *
+ * parms:
+ *	number of lines on the board
+ *
+ * returns:
+ *	pointer to the engine built for that size, or the general engine
+ */
+struct engine *e_select( int size )
+{	register struct engine *ep;
+	static int built = FALSE;
+
+	if (!built)
+	{	k_init();
+		built = TRUE;
+	}
+
+	for( ep = engines; ep->e_size; ep++ )
+		if (ep->e_size == size)
+			break;
+
+	return( ep );
+}
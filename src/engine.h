@@ -0,0 +1,42 @@
+/*
+ * module:
+ *	engine.h
+ *
+ * purpose:
+ *	to describe the move engines, which carry out the mechanics of
+ *	making and unmaking moves.
+ *
+ * note:
+ *	this header presumes that go.h, move.h and game.h have already
+ *	been included.
+ */
+
+/*
+ * The routines that make and unmake moves (m_estimate, m_do and m_unmove,
+ * and everything under them) are compiled several times from kernel.c:
+ * once for each of the common board sizes, with the size of the board,
+ * the width of the liberty sets and the influence folding function all
+ * fixed at compile time, and once more for boards of any size, with
+ * those taken from the game context.  The engine that suits a game is
+ * chosen (by e_select) whenever the game is reset, and everything that
+ * makes or unmakes moves goes through the game's engine.
+ *
+ * Each engine also comes in a light version (e_light), which skips the
+ * display, tracing, influence and superko bookkeeping.  Playouts (see
+ * playout.c) switch a game over to its light engine while they run.
+ */
+struct engine
+{	int	e_size;		/* board size (0 - any size) */
+	char	*e_name;	/* name, for diagnostics */
+	void	(*e_estimate)( struct game_ctx *gp, struct move *mp );
+	void	(*e_do)( struct game_ctx *gp, struct move *mp );
+	void	(*e_unmove)( struct game_ctx *gp, struct move *mp );
+	struct engine *e_light;	/* light version of this engine */
+};
+
+/* move mechanics, as carried out by the game's engine */
+#define m_estimate(gp,mp)	(*(gp)->g_engine->e_estimate)( gp, mp )
+#define m_do(gp,mp)		(*(gp)->g_engine->e_do)( gp, mp )
+#define m_unmove(gp,mp)		(*(gp)->g_engine->e_unmove)( gp, mp )
+
+struct engine *e_select( int size );
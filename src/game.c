@@ -0,0 +1,154 @@
+/*
+ * module:
+ *	game.c
+ *
+ * purpose:
+ *	creation, initialization and destruction of game contexts
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "zobrist.h"
+
+/*
+ * routine:
+ *	g_new
+ *
+ * purpose:
+ *	to create a new (imaginary) game
+ *
+ * parms:
+ *	size of the board to be used
+ *
+ * returns:
+ *	pointer to the new game context
+ *	0 - unable to allocate one
+ *
+ * note:
+ *	new games are created with the fantasy flag set, so that they
+ *	will never touch the screen.  The caller can clear the flag if
+ *	this is to be the game that gets displayed.
+ */
+struct game_ctx *g_new( int bsize )
+{	register struct game_ctx *gp;
+
+	/* make sure the position hash keys, eye table and pattern keys
+	 * have been built */
+	z_init();
+	p_init();
+	q_init();
+
+	gp = (struct game_ctx *) calloc( 1, sizeof (struct game_ctx) );
+	if (gp == 0)
+	{	d_msg( "Unable to allocate a new game context" );
+		return( 0 );
+	}
+
+	if (bsize > MAXBOARD || bsize < 5)
+		bsize = DEFBOARD;
+	gp->g_size = bsize;
+	gp->g_fantasy = TRUE;
+
+	g_reset( gp );
+	return( gp );
+}
+
+/*
+ * routine:
+ *	g_reset
+ *
+ * purpose:
+ *	to reset all of the data structures in a game to scratch
+ *
+ * parms:
+ *	game to be reset (g_size indicates the board size to be used)
+ */
+void g_reset( struct game_ctx *gp )
+{
+	gp->g_engine = e_select( gp->g_size );
+
+	h_reset( gp );	/* clear out the move history */
+	b_reset( gp );	/* reset the display board */
+	m_reset( gp );	/* reset the mechanical boards */
+	q_reset( gp );	/* and the pattern hashes, if any */
+	l_reset( gp );	/* reset the liberty lists */
+	i_reset( gp );	/* reset the influence board */
+	k_reset( gp );	/* forget all previous positions */
+	u_update( gp );	/* nothing is safe on an empty board */
+}
+
+/*
+ * routine:
+ *	g_copy
+ *
+ * purpose:
+ *	to make one game into a copy of another
+ *
+ * parms:
+ *	game to become the copy
+ *	game to be copied
+ *
+ * note:
+ *	the copy is made by replaying the moves of the original, so that
+ *	every move has the same number (and the same strings, liberties
+ *	and history) in both games.  The copy keeps its own fantasy flag,
+ *	and is a separate game from then on: either can be changed (e.g.
+ *	by another thread) without affecting the other.
+ */
+void g_copy( struct game_ctx *gp, struct game_ctx *op )
+{	register struct move *mp, *np;
+	register int n;
+
+	gp->g_size = op->g_size;
+	g_reset( gp );
+
+	for( n = 1; n < op->g_movenum; n++ )
+	{	if ((mp = h_newmove( gp )) == 0)
+			break;
+		np = MOVE( op, n );
+		mp->m_flags = np->m_flags;
+		mp->m_pos = np->m_pos;
+		if (mp->m_pos.row_col)
+		{	m_estimate( gp, mp );
+			m_do( gp, mp );
+		} else
+		{	mp->m_point = 0;
+			mp->m_stones = 0;
+			mp->m_libs = 0;
+			mp->m_kills = 0;
+			mp->m_ataris = 0;
+			mp->m_ko.row_col = 0;
+		}
+		gp->g_movenum++;
+	}
+
+	gp->g_nxtcolor = op->g_nxtcolor;
+	u_update( gp );
+}
+
+/*
+ * routine:
+ *	g_free
+ *
+ * purpose:
+ *	to release a game that is no longer needed
+ *
+ * parms:
+ *	game to be released
+ */
+void g_free( struct game_ctx *gp )
+{
+	if (gp == cur_game)
+		cur_game = 0;
+	if (gp->g_seen)
+		free( (char *) gp->g_seen );
+	h_release( gp );
+	l_release( gp );
+	q_release( gp );
+	free( (char *) gp );
+}
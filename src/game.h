@@ -0,0 +1,97 @@
+/*
+ * module:
+ *	game.h
+ *
+ * purpose:
+ *	to describe the game context, which gathers together all of the
+ *	state that describes a single game in progress.
+ *
+ * note:
+ *	this header presumes that go.h, move.h, libs.h and strings.h
+ *	have already been included.
+ */
+
+/*
+ * Everything that changes as moves are made and unmade lives in the
+ * game context, rather than in globals, so that a single process can
+ * keep any number of independent games alive at once (e.g. imaginary
+ * games being played out for analysis).  Every routine that examines
+ * or changes the state of a game (m_*, l_*, b_*, the engines) is passed
+ * the context of the game on which it is to operate.
+ *
+ * The game being played at the console is cur_game (see go.h).  Only
+ * that game is ever drawn on the screen.  Games that are not intended
+ * for display are created with g_fantasy set, which suppresses all
+ * display board and screen updates.
+ */
+struct game_ctx
+{	/* basic description of the game */
+	int	g_size;		/* number of lines on this board */
+	struct engine *g_engine; /* move engine for this size (engine.h) */
+	int	g_movenum;	/* number of the move about to be made */
+	int	g_nxtcolor;	/* color to move next */
+	int	g_fantasy;	/* suppress board updates - imaginary moves */
+	hash_t	g_hash;		/* zobrist hash of the stones on the board */
+
+	/* real numbers, relating to the current score */
+	int	g_bkills;	/* number of black prisoners taken */
+	int	g_wkills;	/* number of white prisoners taken */
+	int	g_vacancies;	/* number of un-filled points on board */
+
+	/* estimates, describing the perceived state of the board */
+	int	g_dames;	/* estimated number of dames */
+	int	g_bterr;	/* estimated black points controlled */
+	int	g_wterr;	/* estimated white points controlled */
+
+	/* positions that have occurred in this game (see superko.c) */
+	hash_t	*g_seen;	/* open hash table of position hashes */
+	int	g_seenmask;	/* size of that table, less one */
+	int	g_nseen;	/* number of positions in that table */
+
+	/* move history, in chunks of MOVECHUNK moves (see move.h) */
+	struct move **g_movechunk;	/* directory of move chunks */
+	int	g_nmchunks;		/* number of chunks allocated */
+	int	g_movehigh;		/* moves cleared since the reset */
+
+	/* arena of liberty sets (see libs.h) */
+	lword_t	**g_libchunk;		/* chunks of liberty set words */
+	int	g_nchunks;		/* number of chunks allocated */
+	int	g_curchunk;		/* chunk now being carved up */
+	lword_t	*g_libnext;		/* next uncarved word */
+	lword_t	*g_libend;		/* end of the current chunk */
+	int	g_libwords;		/* words in each liberty set */
+	int	g_libhigh;		/* number of sets carved out */
+
+	/* boards, all indexed by point number (see go.h) */
+
+	/* string board (see strings.h) */
+	struct string g_str[ P_POINTS ];
+
+	/* region board, and the regions of vacant points (see strings.h) */
+	short	g_rgn[ P_POINTS ];	/* region of each vacant point */
+	short	g_rnext[ P_POINTS ];	/* next point in its region's ring */
+	short	g_rprev[ P_POINTS ];	/* previous point in that ring */
+	int	g_rmark[ P_POINTS ];	/* marks left by region searches */
+	int	g_rgen;			/* mark for the latest search */
+	struct region g_region[ E_MAXREGIONS ];	/* the regions */
+	short	g_rfree[ E_MAXREGIONS ];	/* numbers of unused regions */
+	int	g_nrfree;		/* number of unused regions */
+
+	/* pattern board (see strings.h) */
+	unsigned long g_pat[ P_POINTS ];
+
+	/* hashes of the large patterns around each point (see pattern.h) */
+	struct qpoint *g_qpat;	/* rings of each point (0 - none kept) */
+	int	g_qtrack;	/* light engine moves keep them, too */
+	int	g_qon;		/* the move being made (or unmade) keeps them */
+
+	/* safe board: points held for good by each color (see benson.c) */
+	char	g_safe[ P_POINTS ];
+
+	/* influence board, and its edge folding function (see inf.h) */
+	short	g_inf[ P_POINTS ];
+	int	g_fold[ MAXBOARD + 7 ];
+
+	/* display board (see disp.h) */
+	unsigned long g_dsp[ P_POINTS ];
+};
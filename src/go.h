@@ -21,11 +21,12 @@
 /*
  * tunable constants and parameters
  */
-#define MAXBOARD 19	/* largest allowable go board */
+#define MAXBOARD 37	/* largest allowable go board */
+#define DEFBOARD 19	/* board used unless another is asked for */
 #define MAXHAND 40	/* largest conceivable handicap */
 #define MAXLINE 100	/* size of console input buffers */
-#define MAXLIBS 1500	/* size of the pool of liberty descriptors */
-#define MAXMOVE	300	/* size of the move history record */
+#define LIBCHUNK 4096	/* words per chunk of the liberty arena */
+#define MAXMOVE	32767	/* highest move number (kept in shorts) */
 
 #define GOSAVE	"go.sav"	/* default save file */
 
@@ -40,6 +41,54 @@ union position
 
 typedef union position pos_t;
 
+/*
+ * columns are named by letters: a-z, and then A-Z for columns beyond
+ * the 26th (only boards larger than 26 lines have any such columns)
+ */
+#define COLNAME(col)	((col) <= 26 ? 'a' + (col) - 1 : 'A' + (col) - 27)
+#define COLNUM(c)	((c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 1 : \
+			 (c) >= 'A' && (c) <= 'Z' ? (c) - 'A' + 27 : 0)
+
+/*
+ * All of the boards kept for a game (string, influence and display) are
+ * one dimensional arrays, indexed by point number.  Every row is padded
+ * with a border column, and there is a border row above and below the
+ * board, so the four neighbors of any point on the board are found at
+ * the constant offsets in p_adj[] (some of them may be border points).
+ * A pos_t is converted to a point number once, when a move is examined,
+ * and everything after that works with point numbers.
+ */
+#define P_STRIDE	(MAXBOARD+2)		/* points in a padded row */
+#define P_POINTS	(P_STRIDE * P_STRIDE)	/* points in a padded board */
+#define P_INDEX(row,col) ((row) * P_STRIDE + (col))
+#define P_POINT(pos)	P_INDEX( (pos).sub.row, (pos).sub.col )
+#define P_ROW(pt)	((pt) / P_STRIDE)
+#define P_COL(pt)	((pt) % P_STRIDE)
+
+#define P_ADJ	{ 1, P_STRIDE, -P_STRIDE, -1 }	/* see mechanix.c */
+int p_adj[4];		/* offsets from a point to its four neighbors */
+#define P_RING	{ P_STRIDE, P_STRIDE + 1, 1, 1 - P_STRIDE, \
+		  -P_STRIDE, -P_STRIDE - 1, -1, P_STRIDE - 1 }
+int p_ring[8];		/* offsets to the eight points around a point */
+
+/* the fates of groups, as read out by v_status (see life.c) */
+#define V_UNKNOWN	0	/* not shut in, or too hard to read */
+#define V_ALIVE		1	/* lives, whatever the enemy does */
+#define V_DEAD		2	/* dies, whatever its owner does */
+#define V_KO		3	/* lives or dies with a ko */
+
+/* whether a point is held for good by a color (see benson.c) */
+#define U_SAFE(gp,pt,color)	((gp)->g_safe[pt] & (1 << (color)))
+
+typedef unsigned long long hash_t;	/* 64-bit position hash key */
+typedef unsigned long long lword_t;	/* one word of a liberty bit set */
+
+/* the game context is described in game.h, pattern hashes in
+ * pattern.h, and game records in move.h */
+struct game_ctx;
+struct qpoint;
+struct record;
+
 /*
  * global parameters and state variables, likely to be of use in all
  * modules of the program
@@ -49,7 +98,7 @@ typedef union position pos_t;
 char *version;		/* the program name / version */
 char gamename[MAXLINE];	/* name that has been assigned to this game */
 char p_name[32];	/* name of the human being we are playing */
-int  boardsize;		/* number of lines on the board */
+int  boardsize;		/* number of lines on the displayed board */
 int  c_ability;		/* computer's ability (positive, I'm sure) */
 int  my_color;		/* color the computer is playing */
 int  p_ability;		/* player's ability (positive Q, negative Dan) */
@@ -60,54 +109,125 @@ int file_echo;		/* echo commands while processing files */
 int no_blunders;	/* disallow self-atari moves */
 int verbose;		/* verbose output is requested */
 
-/* real numbers, relating to the current score */
-int b_kills;	/* number of black prisoners taken */
-int w_kills;	/* number of white prisoners taken */
-int vacancies;	/* number of un-filled points on board */
+/* parameters for the computer's own moves (see search.c) */
+int mc_playouts;	/* playouts per move */
+int mc_seconds;		/* seconds per move (0 - use mc_playouts) */
+int mc_threads;		/* threads to search with (0 - one per cpu) */
+int mc_ponder;		/* search while the opponent thinks */
+double komi;		/* points given to white for moving second */
 
-/* real numbers, relating to the instantaneous state of the game */
-int movenum;	/* number of the move about to be made */
-int nxt_color;	/* color to move next */
+/* the game being played at the console (see game.h) */
+struct game_ctx *cur_game;
 
 /* parameters that affect the display of the game */
 int darkness;		/* suppress display updates - a redraw is planned */
-int fantasy;		/* suppress board updates - making imaginary moves */
-
-/* estimates, describing the current perceived state of the board */
-int dames;	/* estimated number of dames */
-int b_terr;	/* estimated black points controlled */
-int w_terr;	/* estimated white points controlled */
 
-/* other incidental parameters */
-int pillage;	/* the last move whose liberties have been canibalized */
+/* declarations for game context functions */
+struct game_ctx *g_new( int bsize );
+void g_reset( struct game_ctx *gp );
+void g_copy( struct game_ctx *gp, struct game_ctx *op );
+void g_free( struct game_ctx *gp );
+
+/* declarations for unconditional life (see benson.c) */
+void u_update( struct game_ctx *gp );
+
+/* declarations for pattern codes (see strings.h) */
+unsigned long x_code( struct game_ctx *gp, int pt );
+
+/* declarations for large patterns (see pattern.h) */
+void q_init();
+void q_build( struct game_ctx *gp, struct qpoint *qp );
+void q_attach( struct game_ctx *gp );
+void q_reset( struct game_ctx *gp );
+void q_release( struct game_ctx *gp );
+void q_flip( struct game_ctx *gp, int pt, int color );
+int q_rate( struct game_ctx *gp, int pt, int color );
+int q_learn( struct game_ctx *gp );
+int q_load( char *file, int loud );
+int q_save( char *file );
+void q_clear();
+void q_show( struct game_ctx *gp );
+void c_patterns( char *arg );
+
+/* declarations for the joseki dictionary (see joseki.h) */
+int j_open( char *file, int loud );
+void j_close();
+int j_learn( struct record *rp );
+void j_forget();
+int j_save( char *file );
+int j_reply( struct game_ctx *gp );
+void j_show( struct game_ctx *gp );
+void c_joseki( char *arg );
+
+/* declarations for the opening book (see book.h) */
+int b_open( char *file, int loud );
+void b_close();
+int b_build( char *dir, char *file, int depth );
+int b_reply( struct game_ctx *gp );
+void b_show( struct game_ctx *gp );
+void c_book( char *arg );
+
+/* declarations for superko (position history) functions */
+void k_reset( struct game_ctx *gp );
+void k_add( struct game_ctx *gp, hash_t hash );
+void k_remove( struct game_ctx *gp, hash_t hash );
+int k_count( struct game_ctx *gp, hash_t hash );
+
+/* declarations for playout and search functions */
+void p_init();
+int p_eye( struct game_ctx *gp, int pt, int color );
+int p_legal( struct game_ctx *gp, int pt );
+int p_make( struct game_ctx *gp, int pt );
+void p_back( struct game_ctx *gp, int first );
+int p_playout( struct game_ctx *gp, unsigned long *seed );
+int p_score( struct game_ctx *gp );
+void p_speed( struct game_ctx *gp, int count );
+int s_search( struct game_ctx *gp );
+void s_ponder( struct game_ctx *gp, int on );
+void s_follow( struct game_ctx *gp );
+int r_ladder( struct game_ctx *gp, int pt );
+int r_capture( struct game_ctx *gp, int pt, int *movep );
+int r_escape( struct game_ctx *gp, int pt, int *movep );
+int v_status( struct game_ctx *gp, int pt, int color, int *movep );
+int v_eyes( struct game_ctx *gp, int pt );
+void t_resize( int megs );
+void t_init();
+void t_clear();
+void t_flush();
+int t_probe( hash_t key, hash_t *datap );
+void t_store( hash_t key, int depth, int flags, int value );
+void t_show();
+void c_search( char *arg );
 
 /* declarations for general game functions */
 void c_newgame( int bsize );
-void h_reset();
+void h_reset( struct game_ctx *gp );
+void h_release( struct game_ctx *gp );
 void c_move( int color, char *position, int flags );
 void c_unmove( int nmove );
-void m_logmove( FILE *file, int num );
+void m_logmove( struct game_ctx *gp, FILE *file, int num );
 void c_handicap( int num );
 void c_spot( char *arg );
 int chkmove( char *arg );
 void c_save( char *file );
+int a_record( char *file, struct record *rp );
 void c_replay( char *arg );
 char *nicedate( long date );
 void c_debug( char *arg );
 void c_info( char *arg );
 void c_estimate( char *arg );
 int confirm( char *str, ...);
-void b_reset();
-unsigned short b_set( unsigned row, unsigned col, unsigned color, int type, int shade, int moveno );
-unsigned short b_tag( unsigned row, unsigned col, int type, int shade );
-void b_boardsize( int size );
-void b_remove( unsigned row, unsigned col );
-void b_update( unsigned row, unsigned col );
-void b_redraw( int all );
-
-void l_reset();
-void i_reset();
-void delta_inf( unsigned row, unsigned col, unsigned color, int new );
+void b_reset( struct game_ctx *gp );
+unsigned long b_set( struct game_ctx *gp, unsigned row, unsigned col, unsigned color, int type, int shade, int moveno );
+unsigned long b_tag( struct game_ctx *gp, unsigned row, unsigned col, int type, int shade );
+void b_boardsize( struct game_ctx *gp, int size );
+void b_remove( struct game_ctx *gp, unsigned row, unsigned col );
+void b_update( struct game_ctx *gp, unsigned row, unsigned col );
+void b_redraw( struct game_ctx *gp, int all );
+
+void l_reset( struct game_ctx *gp );
+void l_release( struct game_ctx *gp );
+void i_reset( struct game_ctx *gp );
 
 /* declarations for display functions	*/
 void d_init();
@@ -126,6 +246,7 @@ void d_showmove( int movnum, char *str );
 
 void docmd( char *cmd );
 
-int est_terr();
-void showterr( char what );
-void showinf();
+int est_terr( struct game_ctx *gp );
+void showterr( struct game_ctx *gp, char what );
+void showinf( struct game_ctx *gp );
+void showlife( struct game_ctx *gp );
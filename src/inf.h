@@ -7,7 +7,12 @@
  *	influenced based board information 
  */
 
-short inf_board[ MAXBOARD+2 ][ MAXBOARD+2 ];
+/*
+ * the influence board itself (g_inf) is part of the game context,
+ * and is described in game.h
+ */
+
+int inf_func[7][7];	/* influence of a stone (see influenc.c) */
 
 #define	I_TH_ARMY	1	/* influence for an army */
 #define I_TH_WALL	10	/* influence for a wall  */
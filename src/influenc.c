@@ -11,6 +11,10 @@
 #include "go.h"
 #include "disp.h"
 #include "inf.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
 
 /*
  * the influence on a point is the sum of the influences of all stones
@@ -45,11 +49,11 @@ int inf_func[7][7] =
  * however, it folds the function back over the points near the edge.
  *
  * Note that this function is (and must be) symmetric about the center of 
- * the board, and identical for both rows and columns.
+ * the board, and identical for both rows and columns.  Since it depends
+ * on the size of the board, each game keeps its own copy (g_fold), and
+ * the engines built for particular board sizes have their own constant
+ * copies.  The routine that applies it (delta_inf) is in kernel.c.
  */
-int inf_fold[ MAXBOARD + 7 ] =
-{	0,3,2,1,1,2,3,4,5,6,7,8,9,10,11,12,13,15,16,17,18,19,19,18,17 
-};
 
 /*
  * routine:
@@ -57,57 +61,24 @@ int inf_fold[ MAXBOARD + 7 ] =
  *
  * purpose:
  *	to reset the influence database to zero
+ *
+ * parms:
+ *	game whose influence board is to be reset
  */
-void i_reset()
+void i_reset( struct game_ctx *gp )
 {	register int r, c;
+	register int *fold = gp->g_fold;
 
 	/* initialize the influence board to zero */
-	for( r = 1; r <= boardsize; r++ )
-		for( c = 1; c <= boardsize; c++ )
-			inf_board[r][c] = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( c = 1; c <= gp->g_size; c++ )
+			gp->g_inf[ P_INDEX( r, c ) ] = 0;
 	
 	/* initialize the influence folding function for the board size */
-	inf_fold[0] = 0; inf_fold[1] = 3; inf_fold[2] = 2; inf_fold[3] = 1;
-	for( r = 1; r <= boardsize; r++ )
-		inf_fold[3+r] = r;
-	inf_fold[3+r] = r-1; inf_fold[4+r] = r-2; inf_fold[5+r] = r-3;
-}
-
-/*
- * routine:
- *	delta_inf
- *
- * purpose:
- *	to compute the delta influence associated with a move
- *
- * parms:
- *	row and column of move being made
- *	color of stone being placed or removed
- *	number of stones being placed (1,-1)
- *
- * note
- *	in order to gracefully/efficiently/reasonably handle placement
- *	of stones near the edges, we use the influence folding function
- *	to determine exactly which columns of the influence function
- *	should be added to which columns of the board.
- */
-void delta_inf( unsigned row, unsigned col, unsigned color, int new )
-{	register int i, j;
-	register int r;
-	int sign = (color == WHITE) ? new : -new;
-
-	if (sign > 0)
-		for( i = 0; i < 7; i++ )
-		{	r = inf_fold[ row+i ];
-			for( j = 0; j < 7; j++ )
-				inf_board[r][inf_fold[col+j]] += inf_func[i][j];
-		}
-	else /* sign < 0 */
-		for( i = 0; i < 7; i++ )
-		{	r = inf_fold[ row+i ];
-			for( j = 0; j < 7; j++ )
-				inf_board[r][inf_fold[col+j]] -= inf_func[i][j];
-		}
+	fold[0] = 0; fold[1] = 3; fold[2] = 2; fold[3] = 1;
+	for( r = 1; r <= gp->g_size; r++ )
+		fold[3+r] = r;
+	fold[3+r] = r-1; fold[4+r] = r-2; fold[5+r] = r-3;
 }
 
 /*
@@ -121,10 +92,13 @@ void delta_inf( unsigned row, unsigned col, unsigned color, int new )
 *	default - shade all armies and walls
 *	i	- display influence functions
 *	t	- shade all controlled vacancies
+*	l	- shade groups that are shut in by whether they live
+*	p	- show how each move is rated by its patterns
 */
 void c_estimate( char *arg )
 {	int score,net;
 	char *winner;
+	register struct game_ctx *gp = cur_game;
 
 	/* default is to display everything */
 	if(arg == 0  ||  *arg==0)
@@ -134,11 +108,11 @@ void c_estimate( char *arg )
 	{ case 't':	/* estimate territory */
 	  case 'w':	/* estimate walls */
 	  case 'a':	/* estimate everything */
-		showterr( *arg );
+		showterr( gp, *arg );
 		break;
 
 	  case 's':	/* estimate score */
-		score = est_terr();
+		score = est_terr( gp );
 		if (score < 0)
 		{	winner = "black";
 			net = -score;
@@ -147,13 +121,22 @@ void c_estimate( char *arg )
 			net = score;
 		}
 		d_msg("Score: %s by %d, b:%d-%d=%d, w:%d-%d=%d, unclaimed=%d",
-			winner, net, b_terr, w_kills, b_terr - w_kills,
-			w_terr, b_kills, w_terr - b_kills,
-			vacancies - b_terr - w_terr );
+			winner, net, gp->g_bterr, gp->g_wkills, 
+			gp->g_bterr - gp->g_wkills, gp->g_wterr, gp->g_bkills, 
+			gp->g_wterr - gp->g_bkills,
+			gp->g_vacancies - gp->g_bterr - gp->g_wterr );
 		return;
 
 	  case 'i':	/* display influence */
-		showinf();
+		showinf( gp );
+		break;
+
+	  case 'l':	/* read out life and death */
+		showlife( gp );
+		break;
+
+	  case 'p':	/* rate moves by their patterns */
+		q_show( gp );
 		break;
 
 	  default:
@@ -162,7 +145,7 @@ void c_estimate( char *arg )
 	}
 
 	(void) confirm( "enter return to resume game" );
-	b_redraw( FALSE );
+	b_redraw( gp, FALSE );
 }
 
 /*
@@ -171,15 +154,18 @@ void c_estimate( char *arg )
  *
  * purpose:
  *	to display the influence functiion
+ *
+ * parms:
+ *	game to be displayed
  */
-void showinf()
+void showinf( struct game_ctx *gp )
 {	register unsigned r, c;
 	unsigned color;
 	int inf, ainf;
 
-	for( r = 1; r <= boardsize; r++ )
-		for( c = 1; c <= boardsize; c++ )
-		{	if (inf = inf_board[r][c])
+	for( r = 1; r <= gp->g_size; r++ )
+		for( c = 1; c <= gp->g_size; c++ )
+		{	if (inf = gp->g_inf[ P_INDEX( r, c ) ])
 			{	if (inf < 0)
 				{	color = BLACK;
 					ainf = -inf;
@@ -205,16 +191,18 @@ void showinf()
  *	to display the influence influence estimated territory
  *
  * parms:
+ *	game to be displayed
  *	what things we should show on display (parm to est command)
  */
-void showterr( char what )
+void showterr( struct game_ctx *gp, char what )
 {	register unsigned r, c;
 	unsigned color;
-	int inf, ainf, stone, shade;
+	int inf, ainf, shade;
+	unsigned long stone;
 
-	for( r = 1; r <= boardsize; r++ )
-		for( c = 1; c <= boardsize; c++ )
-		{	if (inf = inf_board[r][c])
+	for( r = 1; r <= gp->g_size; r++ )
+		for( c = 1; c <= gp->g_size; c++ )
+		{	if (inf = gp->g_inf[ P_INDEX( r, c ) ])
 			{	if (inf < 0)
 				{	color = BLACK;
 					ainf = -inf;
@@ -222,7 +210,7 @@ void showterr( char what )
 				{	color = WHITE;
 					ainf = inf;
 				}
-				stone = dsp_board[r-1][c-1];
+				stone = gp->g_dsp[ P_INDEX( r, c ) ];
 
 				/*
 				 * teritorry displays are wrong, for now
@@ -256,6 +244,62 @@ void showterr( char what )
 	d_update();
 }
 
+/*
+ * routine:
+ *	showlife
+ *
+ * purpose:
+ *	to display the fates of the groups that are shut in
+ *
+ * parms:
+ *	game to be displayed
+ *
+ * note:
+ *	groups that live are shaded as vital, those that die as imperiled
+ *	(with doomed stones), and those whose fate hangs on who moves first
+ *	as special.  Groups that are not shut in are left alone.
+ */
+void showlife( struct game_ctx *gp )
+{	register unsigned r, c;
+	register int pt, q;
+	int kill, live, shade, type, move;
+	char done[ MAXMOVE + 1 ];
+
+	t_init();
+	for( pt = 0; pt <= MAXMOVE; pt++ )
+		done[pt] = 0;
+
+	for( r = 1; r <= gp->g_size; r++ )
+		for( c = 1; c <= gp->g_size; c++ )
+		{	/* look at each string once */
+			pt = P_INDEX( r, c );
+			if (gp->g_str[pt].s_moveno <= 0  ||  done[ gp->g_str[pt].s_moveno ])
+				continue;
+			done[ gp->g_str[pt].s_moveno ] = 1;
+
+			kill = v_status( gp, pt, !gp->g_str[pt].s_color, &move );
+			live = v_status( gp, pt, gp->g_str[pt].s_color, &move );
+			type = B_NORMAL;
+			if (kill == V_ALIVE)
+				shade = B_VITAL;
+			else if (live == V_DEAD)
+			{	shade = B_PERRIL;
+				type = B_CORPSE;
+			} else if (kill != V_UNKNOWN  &&  live != V_UNKNOWN)
+				shade = B_SPECIAL;
+			else
+				continue;
+
+			q = pt;
+			do
+			{	d_stone( P_ROW( q ), P_COL( q ), gp->g_str[q].s_color,
+					shade, type );
+				q = gp->g_str[q].s_next;
+			} while( q != pt );
+		}
+	d_update();
+}
+
 /*
  * routine:
  *	est_terr
@@ -263,28 +307,31 @@ void showterr( char what )
  * purpose:
  *	to estimate territory
  *
+ * parms:
+ *	game to be estimated
+ *
  * returns:
- *	settings of b_terr and w_terr;
+ *	net score (positive favors white), after setting g_bterr and g_wterr
  */
-int est_terr()
-{	register int r, c;
+int est_terr( struct game_ctx *gp )
+{	register int r, pt;
 	int inf, ainf;
 
 	/* FIX THIS ROUTINE TO DO SOMETHING REASONABLE */
-	b_terr = w_terr = 0;
-	for( r = 1; r <= boardsize; r++ )
-		for( c = 1; c <= boardsize; c++ )
-		{	if (inf = inf_board[r][c])
-			{	if (dsp_board[r-1][c-1])
+	gp->g_bterr = gp->g_wterr = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	if (inf = gp->g_inf[pt])
+			{	if (gp->g_str[pt].s_moveno)
 					continue;
 				ainf = (inf > 0) ? inf : -inf;
 				if (ainf > I_TH_WALL)
 					if (inf > 0)
-						w_terr++;
+						gp->g_wterr++;
 					else
-						b_terr++;
+						gp->g_bterr++;
 			}
 		}
 
-	return( w_terr + w_kills - b_terr - b_kills );
+	return( gp->g_wterr + gp->g_wkills - gp->g_bterr - gp->g_bkills );
 }
@@ -0,0 +1,757 @@
+/*
+ * module:
+ *	joseki.c
+ *
+ * purpose:
+ *	to build the joseki dictionary from game records, and to look up
+ *	the sequences being played in the corners of a game in it
+ *
+ * note:
+ *	see joseki.h for how corner sequences are encoded, and how the
+ *	dictionary is laid out.  A dictionary is built in memory, written
+ *	to a file, and then used by mapping that file.  The two need not
+ *	be the same: the one being built is only for writing.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "go.h"
+#include "disp.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "joseki.h"
+
+/* the dictionary in use (mapped from its file) */
+static char *j_map;		/* the whole file */
+static size_t j_maplen;		/* its length */
+static struct jheader *j_dict;	/* its header */
+static struct jnode *j_nodes;	/* and its nodes */
+
+/* the dictionary being built: a node's children are linked together */
+struct jbuild
+{	int	b_kid;		/* first child (0 - none) */
+	int	b_next;		/* next child of the same parent */
+	int	b_count;	/* corners that went through it */
+	int	b_move;		/* move code */
+};
+static struct jbuild *j_built;	/* the nodes (the root first) */
+static int j_nbuilt;		/* number of nodes */
+static int j_maxbuilt;		/* number there is room for */
+static int j_bsize;		/* size of the board its games were on */
+
+/*
+ * routine:
+ *	j_corner
+ *
+ * purpose:
+ *	to find which corner of the board a point is in
+ *
+ * parms:
+ *	point number
+ *	size of the board
+ *	where to put its x and y in the corner (unturned)
+ *
+ * returns:
+ *	number of the corner (bit 0 - nearer the last row, bit 1 - nearer
+ *	the last column)
+ *	-1 - it is in no corner
+ */
+static int j_corner( int pt, int size, int *xp, int *yp )
+{	int corner = 0;
+	int x = P_COL( pt );
+	int y = P_ROW( pt );
+
+	if (x > size - x + 1)
+	{	x = size - x + 1;
+		corner |= 2;
+	}
+	if (y > size - y + 1)
+	{	y = size - y + 1;
+		corner |= 1;
+	}
+	if (x > J_SPAN( size )  ||  y > J_SPAN( size ))
+		return( -1 );
+
+	*xp = x;
+	*yp = y;
+	return( corner );
+}
+
+/*
+ * routine:
+ *	j_point
+ *
+ * purpose:
+ *	to find the point a move code stands for in a corner
+ *
+ * parms:
+ *	move code
+ *	number of the corner
+ *	TRUE if the corner was turned
+ *	size of the board
+ *
+ * returns:
+ *	point number
+ */
+static int j_point( int code, int corner, int turned, int size )
+{	int x = turned ? J_Y( code ) : J_X( code );
+	int y = turned ? J_X( code ) : J_Y( code );
+
+	if (corner & 2)
+		x = size - x + 1;
+	if (corner & 1)
+		y = size - y + 1;
+	return( P_INDEX( y, x ) );
+}
+
+/*
+ * routine:
+ *	j_sequence
+ *
+ * purpose:
+ *	to encode the moves played in one corner
+ *
+ * parms:
+ *	points of the moves (0 - pass)
+ *	colors of the moves
+ *	number of moves
+ *	number of the corner
+ *	size of the board
+ *	where to put the move codes (J_MAXLEN of them)
+ *	where to note whether the corner was turned (0 - don't)
+ *	where to put the color that moved first there (0 - don't)
+ *
+ * returns:
+ *	number of moves played in the corner (only the first J_MAXLEN
+ *	of them are encoded)
+ */
+static int j_sequence( short *points, char *colors, int nmoves, int corner,
+		int size, short *codes, int *turnedp, int *firstp )
+{	register int n, i;
+	int x = 0, y = 0, t, first = 0;
+	int turned = FALSE;
+	int even = TRUE;	/* every move so far is on the diagonal */
+
+	for( i = n = 0; i < nmoves; i++ )
+	{	if (points[i] == 0  ||  j_corner( points[i], size, &x, &y ) != corner)
+			continue;
+		if (n >= J_MAXLEN)
+		{	n++;		/* too far in to be followed */
+			continue;
+		}
+
+		if (n == 0)
+			first = colors[i];
+		if (even  &&  x != y)
+		{	even = FALSE;
+			turned = x > y;
+		}
+		if (turned)
+		{	t = x;
+			x = y;
+			y = t;
+		}
+		codes[ n++ ] = J_CODE( x, y, colors[i] != first );
+	}
+
+	if (turnedp)
+		*turnedp = turned;
+	if (firstp)
+		*firstp = first;
+	return( n );
+}
+
+/*
+ * routine:
+ *	j_history
+ *
+ * purpose:
+ *	to list the moves of a game
+ *
+ * parms:
+ *	game whose moves are wanted
+ *	where to put their points
+ *	where to put their colors
+ *
+ * returns:
+ *	number of moves (no more than MAXRECORD)
+ */
+static int j_history( struct game_ctx *gp, short *points, char *colors )
+{	register struct move *mp;
+	register int n;
+
+	for( n = 1; n < gp->g_movenum  &&  n <= MAXRECORD; n++ )
+	{	mp = MOVE( gp, n );
+		points[n-1] = mp->m_point;
+		colors[n-1] = mp->m_flags & M_COLOR;
+	}
+	return( n - 1 );
+}
+
+/*
+ * routine:
+ *	j_kids
+ *
+ * purpose:
+ *	to find the children of a node of the dictionary
+ *
+ * parms:
+ *	number of the node
+ *	where to put the number of children
+ *
+ * returns:
+ *	pointer to the first of them
+ *	0 - there are none (or they lie outside the dictionary)
+ *
+ * note:
+ *	a dictionary is not checked when it is mapped, since that would
+ *	mean reading all of it, so a node's children are checked each time
+ *	they are looked at, to keep a bad file from sending us elsewhere.
+ */
+static struct jnode *j_kids( int node, int *np )
+{	register struct jnode *jp = &j_nodes[node];
+	unsigned nnodes = (unsigned) j_dict->j_nnodes;
+
+	*np = 0;
+	if (jp->j_nkids == 0  ||  jp->j_kids > nnodes  ||
+		jp->j_nkids > nnodes - jp->j_kids)
+		return( 0 );
+	*np = jp->j_nkids;
+	return( &j_nodes[ jp->j_kids ] );
+}
+
+/*
+ * routine:
+ *	j_find
+ *
+ * purpose:
+ *	to follow a sequence of moves down the dictionary
+ *
+ * parms:
+ *	move codes
+ *	number of them
+ *
+ * returns:
+ *	number of the node for the last of them (0 - the root)
+ *	-1 - the sequence is not in the dictionary
+ */
+static int j_find( short *codes, int n )
+{	register struct jnode *kp;
+	register int lo, hi, mid;
+	int i, nkids, node = 0;
+
+	for( i = 0; i < n; i++ )
+	{	if ((kp = j_kids( node, &nkids )) == 0)
+			return( -1 );
+		lo = 0;
+		hi = nkids;
+		while( lo < hi )
+		{	mid = (lo + hi) / 2;
+			if (kp[mid].j_move < codes[i])
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == nkids  ||  kp[lo].j_move != codes[i])
+			return( -1 );
+		node = (kp - j_nodes) + lo;
+	}
+
+	return( node );
+}
+
+/*
+ * routine:
+ *	j_close
+ *
+ * purpose:
+ *	to stop using the dictionary
+ */
+void j_close()
+{
+	if (j_map)
+		(void) munmap( j_map, j_maplen );
+	j_map = 0;
+	j_maplen = 0;
+	j_dict = 0;
+	j_nodes = 0;
+}
+
+/*
+ * routine:
+ *	j_open
+ *
+ * purpose:
+ *	to start using a dictionary (instead of any we had)
+ *
+ * parms:
+ *	name of the dictionary file
+ *	TRUE if a missing file should be complained about
+ *
+ * returns:
+ *	number of nodes in it
+ *	-1 - it could not be used
+ */
+int j_open( char *file, int loud )
+{	struct stat st;
+	struct jheader *hp;
+	char *map;
+	int fd;
+
+	if ((fd = open( file, O_RDONLY )) < 0)
+	{	if (loud)
+			d_msg( "Unable to open joseki file: %s", file );
+		return( -1 );
+	}
+
+	map = MAP_FAILED;
+	if (fstat( fd, &st ) == 0  &&  st.st_size >= sizeof (struct jheader))
+		map = (char *) mmap( 0, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	(void) close( fd );
+	if (map == MAP_FAILED)
+	{	d_msg( "Unable to map joseki file: %s", file );
+		return( -1 );
+	}
+
+	/* make sure it is what it claims to be */
+	hp = (struct jheader *) map;
+	if (memcmp( hp->j_magic, J_MAGIC, sizeof hp->j_magic ) != 0  ||
+		hp->j_nnodes <= 0  ||  st.st_size != sizeof (struct jheader) +
+		(size_t) hp->j_nnodes * sizeof (struct jnode))
+	{	d_msg( "Not a joseki dictionary: %s", file );
+		(void) munmap( map, (size_t) st.st_size );
+		return( -1 );
+	}
+
+	j_close();
+	j_map = map;
+	j_maplen = (size_t) st.st_size;
+	j_dict = hp;
+	j_nodes = (struct jnode *) (map + sizeof (struct jheader));
+	return( hp->j_nnodes );
+}
+
+/*
+ * routine:
+ *	j_add
+ *
+ * purpose:
+ *	to add a sequence of moves to the dictionary being built
+ *
+ * parms:
+ *	move codes
+ *	number of them
+ *
+ * returns:
+ *	TRUE	it was added
+ *	FALSE	there is no room
+ */
+static int j_add( short *codes, int n )
+{	register struct jbuild *bp;
+	register int i, k;
+	int node = 0;
+
+	for( i = 0; i <= n; i++ )
+	{	if (i > 0)
+		{	/* find this move among the children, or add it */
+			for( k = j_built[node].b_kid; k; k = j_built[k].b_next )
+				if (j_built[k].b_move == codes[i-1])
+					break;
+			if (k == 0)
+			{	if (j_nbuilt >= j_maxbuilt)
+				{	k = j_maxbuilt ? 2 * j_maxbuilt : 4096;
+					bp = (struct jbuild *) realloc( (char *) j_built,
+						k * sizeof (struct jbuild) );
+					if (bp == 0)
+						return( FALSE );
+					j_built = bp;
+					j_maxbuilt = k;
+				}
+				k = j_nbuilt++;
+				j_built[k].b_kid = 0;
+				j_built[k].b_count = 0;
+				j_built[k].b_move = codes[i-1];
+				j_built[k].b_next = j_built[node].b_kid;
+				j_built[node].b_kid = k;
+			}
+			node = k;
+		}
+		j_built[node].b_count++;
+	}
+
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	j_learn
+ *
+ * purpose:
+ *	to add the corner sequences of a game to the dictionary being built
+ *
+ * parms:
+ *	game record
+ *
+ * returns:
+ *	number of corners added
+ *	-1 - there is no room
+ *
+ * note:
+ *	corners where nothing was played are left out, and only the first
+ *	J_MAXLEN moves of the others are added.  All of the games must be
+ *	on boards of one size (that of the first); a game on a board of any
+ *	other size is not added, and no corners are counted for it.
+ */
+int j_learn( struct record *rp )
+{	short codes[ J_MAXLEN ];
+	int corner, n, added = 0;
+
+	if (j_nbuilt == 0)
+	{	/* start with a root */
+		if ((j_built = (struct jbuild *) malloc( 4096 * sizeof (struct jbuild) )) == 0)
+			return( -1 );
+		j_maxbuilt = 4096;
+		j_built[0].b_kid = j_built[0].b_next = 0;
+		j_built[0].b_count = j_built[0].b_move = 0;
+		j_nbuilt = 1;
+		j_bsize = rp->r_size;
+	} else if (rp->r_size != j_bsize)
+		return( 0 );
+
+	for( corner = 0; corner < 4; corner++ )
+	{	n = j_sequence( rp->r_point, rp->r_color, rp->r_nmoves, corner,
+			rp->r_size, codes, (int *) 0, (int *) 0 );
+		if (n <= 0)
+			continue;
+		if (!j_add( codes, n < J_MAXLEN ? n : J_MAXLEN ))
+			return( -1 );
+		added++;
+	}
+
+	return( added );
+}
+
+/*
+ * routine:
+ *	j_forget
+ *
+ * purpose:
+ *	to throw away the dictionary being built
+ */
+void j_forget()
+{
+	if (j_built)
+		free( (char *) j_built );
+	j_built = 0;
+	j_nbuilt = j_maxbuilt = 0;
+}
+
+/*
+ * routine:
+ *	j_save
+ *
+ * purpose:
+ *	to write the dictionary being built out to a file
+ *
+ * parms:
+ *	name of the file
+ *
+ * returns:
+ *	number of nodes written
+ *	-1 - it could not be written
+ *
+ * note:
+ *	the nodes are numbered in breadth first order (order[] lists the
+ *	nodes being built in that order), and each node's children are
+ *	sorted as they are listed.
+ */
+int j_save( char *file )
+{	register int i, k, n, m;
+	struct jheader hdr;
+	struct jnode node;
+	int *order;
+	FILE *outfile;
+
+	if (j_nbuilt == 0)
+	{	d_msg( "No joseki have been learned" );
+		return( -1 );
+	}
+	if ((order = (int *) malloc( j_nbuilt * sizeof (int) )) == 0)
+	{	d_msg( "Unable to allocate space to write the joseki" );
+		return( -1 );
+	}
+	if ((outfile = fopen( file, "w" )) == NULL)
+	{	d_msg( "Unable to create joseki file: %s", file );
+		free( (char *) order );
+		return( -1 );
+	}
+
+	(void) memset( (char *) &hdr, 0, sizeof hdr );
+	(void) memcpy( hdr.j_magic, J_MAGIC, sizeof hdr.j_magic );
+	hdr.j_size = j_bsize;
+	hdr.j_nnodes = j_nbuilt;
+	(void) fwrite( (char *) &hdr, sizeof hdr, 1, outfile );
+
+	order[0] = 0;
+	n = 1;
+	for( i = 0; i < j_nbuilt; i++ )
+	{	/* list the children, in order of their moves */
+		node.j_kids = n;
+		for( k = j_built[ order[i] ].b_kid; k; k = j_built[k].b_next )
+		{	for( m = n++; m > (int) node.j_kids  &&
+				j_built[ order[m-1] ].b_move > j_built[k].b_move; m-- )
+				order[m] = order[m-1];
+			order[m] = k;
+		}
+		node.j_nkids = n - node.j_kids;
+		node.j_move = j_built[ order[i] ].b_move;
+		node.j_count = j_built[ order[i] ].b_count;
+		(void) fwrite( (char *) &node, sizeof node, 1, outfile );
+	}
+
+	free( (char *) order );
+	if (fclose( outfile ) != 0)
+	{	d_msg( "Unable to write joseki file: %s", file );
+		return( -1 );
+	}
+	return( j_nbuilt );
+}
+
+/*
+ * routine:
+ *	j_reply
+ *
+ * purpose:
+ *	to find the usual reply to a joseki move
+ *
+ * parms:
+ *	game in which the reply would be made
+ *
+ * returns:
+ *	point of the reply
+ *	0 - there is none
+ *
+ * note:
+ *	it is only time for joseki when the last move was made in a corner
+ *	whose sequence is in the dictionary.  The reply made most often
+ *	there is wanted, but only if it was made at least J_MINGAMES times,
+ *	and more often than the player to move played elsewhere.  Past
+ *	move MAXRECORD the history (see j_history) no longer reaches the
+ *	last move, so there are no joseki at all.
+ */
+int j_reply( struct game_ctx *gp )
+{	register struct jnode *kp;
+	register int k;
+	struct move *mp;
+	short points[ MAXRECORD ], codes[ J_MAXLEN ];
+	char colors[ MAXRECORD ];
+	int corner, node, nmoves, n, turned, first, other, x, y, nkids;
+	unsigned best, tenuki;
+
+	if (j_nodes == 0  ||  j_dict->j_size != gp->g_size  ||
+		gp->g_movenum <= 1  ||  gp->g_movenum - 1 > MAXRECORD)
+		return( 0 );
+	mp = MOVE( gp, gp->g_movenum - 1 );
+	if (mp->m_point == 0  ||
+		(corner = j_corner( mp->m_point, gp->g_size, &x, &y )) < 0)
+		return( 0 );
+
+	nmoves = j_history( gp, points, colors );
+	n = j_sequence( points, colors, nmoves, corner, gp->g_size, codes,
+		&turned, &first );
+	if (n <= 0  ||  n >= J_MAXLEN  ||  (node = j_find( codes, n )) < 0)
+		return( 0 );
+
+	other = gp->g_nxtcolor != first;
+	best = tenuki = 0;
+	kp = j_kids( node, &nkids );
+	for( k = 0; k < nkids; k++ )
+		if (J_OTHER( kp[k].j_move ) != other)
+			tenuki += kp[k].j_count;
+		else if (kp[k].j_count > best)
+		{	best = kp[k].j_count;
+			x = kp[k].j_move;
+		}
+
+	if (best < J_MINGAMES  ||  best <= tenuki)
+		return( 0 );
+	return( j_point( x, corner, turned, gp->g_size ) );
+}
+
+/*
+ * routine:
+ *	j_show
+ *
+ * purpose:
+ *	to display the moves that followed the sequence in each corner
+ *	(the j command), with the number of times each was played
+ *
+ * parms:
+ *	game to be displayed
+ *
+ * note:
+ *	moves are shown in the color of the player who made them.  While
+ *	the corner has not been turned, the same move may be made on
+ *	either side of the diagonal, so both are shown.
+ */
+void j_show( struct game_ctx *gp )
+{	register struct jnode *kp;
+	register int k;
+	short points[ MAXRECORD ], codes[ J_MAXLEN ];
+	char colors[ MAXRECORD ];
+	int corner, node, nmoves, n, turned, first, color, pt, shown, nkids;
+
+	if (j_nodes == 0  ||  j_dict->j_size != gp->g_size)
+	{	d_msg( "No joseki dictionary for a %d line board", gp->g_size );
+		return;
+	}
+	if (gp->g_movenum - 1 > MAXRECORD)
+	{	d_msg( "Joseki are not followed past move %d", MAXRECORD );
+		return;
+	}
+
+	nmoves = j_history( gp, points, colors );
+	shown = 0;
+	for( corner = 0; corner < 4; corner++ )
+	{	n = j_sequence( points, colors, nmoves, corner, gp->g_size,
+			codes, &turned, &first );
+		if (n >= J_MAXLEN  ||  (node = j_find( codes, n )) < 0)
+			continue;
+
+		/* in an empty corner, either player might move first */
+		kp = j_kids( node, &nkids );
+		for( k = 0; k < nkids; k++ )
+		{	if (J_X( kp[k].j_move ) > J_SPAN( gp->g_size )  ||
+				J_Y( kp[k].j_move ) > J_SPAN( gp->g_size ))
+				continue;
+			color = (n == 0) ? gp->g_nxtcolor :
+				J_OTHER( kp[k].j_move ) ? !first : first;
+			pt = j_point( kp[k].j_move, corner, turned, gp->g_size );
+			if (gp->g_str[pt].s_moveno == 0)
+				d_value( P_ROW( pt ), P_COL( pt ), color, B_ARMY,
+					(int) kp[k].j_count );
+			pt = j_point( kp[k].j_move, corner, !turned, gp->g_size );
+			if (!turned  &&  gp->g_str[pt].s_moveno == 0)
+				d_value( P_ROW( pt ), P_COL( pt ), color, B_ARMY,
+					(int) kp[k].j_count );
+			shown++;
+		}
+	}
+	d_update();
+	d_msg( "%d joseki moves known here", shown );
+}
+
+/*
+ * routine:
+ *	c_joseki
+ *
+ * purpose:
+ *	to build, use and display joseki dictionaries (the j command)
+ *
+ * parms:
+ *	argument string
+ *		(none)	   show the known moves in each corner
+ *		l <files>  learn the joseki of saved games (the current
+ *			   game, if no files are named)
+ *		w <file>   write the joseki learned out to a dictionary
+ *		r <file>   use a dictionary
+ *		c	   forget the joseki learned
+ *	files default to J_DEFFILE
+ */
+void c_joseki( char *arg )
+{	register char *s, *e;
+	struct record *rp;
+	char name[ MAXLINE ];
+	int n, games, corners, skipped;
+
+	s_ponder( cur_game, FALSE );
+
+	if (arg == 0  ||  *arg == 0)
+	{	j_show( cur_game );
+		(void) confirm( "enter return to resume game" );
+		b_redraw( cur_game, FALSE );
+		return;
+	}
+
+	/* find the file name(s), if any */
+	for( s = arg; *s && *s != ' ' && *s != '\t'; s++ );
+	while( *s == ' ' || *s == '\t' )
+		s++;
+
+	switch( *arg )
+	{ case 'l':	/* learn from games */
+		if ((rp = (struct record *) malloc( sizeof (struct record) )) == 0)
+		{	d_msg( "Unable to allocate a game record" );
+			return;
+		}
+		games = corners = skipped = 0;
+		if (*s == 0)
+		{	rp->r_size = cur_game->g_size;
+			rp->r_nmoves = j_history( cur_game, rp->r_point, rp->r_color );
+			if (j_nbuilt > 0  &&  rp->r_size != j_bsize)
+				skipped = 1;
+			else if ((corners = j_learn( rp )) >= 0)
+				games = 1;
+		}
+		for( ; *s; s = e )
+		{	for( e = s; *e && *e != ' ' && *e != '\t'; e++ )
+				;
+			n = (e - s < MAXLINE) ? e - s : MAXLINE - 1;
+			(void) sprintf( name, "%.*s", n, s );
+			while( *e == ' ' || *e == '\t' )
+				e++;
+			if (a_record( name, rp ) < 0)
+			{	d_msg( "Unable to open game file %s", name );
+				continue;
+			}
+
+			/* the games must all be on boards of the same size */
+			if (j_nbuilt > 0  &&  rp->r_size != j_bsize)
+			{	skipped++;
+				continue;
+			}
+			if ((n = j_learn( rp )) < 0)
+			{	corners = -1;
+				break;
+			}
+			corners += n;
+			games++;
+		}
+		free( (char *) rp );
+		if (corners < 0)
+			d_msg( "*** joseki table is full" );
+		else if (skipped)
+			d_msg( "Joseki learned from %d corners of %d games, %d nodes (%d skipped: not on a %d line board)",
+				corners, games, j_nbuilt, skipped, j_bsize );
+		else
+			d_msg( "Joseki learned from %d corners of %d games, %d nodes",
+				corners, games, j_nbuilt );
+		break;
+
+	  case 'w':	/* write a dictionary */
+		if ((n = j_save( *s ? s : J_DEFFILE )) >= 0)
+			d_msg( "%d joseki nodes written to %s", n, *s ? s : J_DEFFILE );
+		break;
+
+	  case 'r':	/* use a dictionary */
+		if ((n = j_open( *s ? s : J_DEFFILE, TRUE )) >= 0)
+			d_msg( "%d joseki nodes in %s", n, *s ? s : J_DEFFILE );
+		break;
+
+	  case 'c':	/* forget what we have learned */
+		j_forget();
+		d_msg( "All joseki learned forgotten" );
+		break;
+
+	  default:
+		d_msg( "Unrecognized joseki request: %s", arg );
+		break;
+	}
+}
@@ -0,0 +1,62 @@
+/*
+ * module:
+ *	joseki.h
+ *
+ * purpose:
+ *	to describe the joseki dictionary: the sequences of moves played
+ *	in the corners of the games it was built from
+ */
+
+/*
+ * A corner is the part of the board within J_SPAN lines of two edges.
+ * Its moves are encoded by where they lie in the corner, counting
+ * lines in from its two edges (x from the side, y from the top or
+ * bottom), so the same sequence played in any corner encodes the same
+ * way.  A corner is also its own
+ * mirror image (across the diagonal), so once the first move off the
+ * diagonal has been played, the corner is turned (x and y exchanged,
+ * for the whole sequence) if need be to put that move below it, with
+ * x < y; the moves on the diagonal before it look the same either
+ * way.  The color of each move is only noted as being that of the
+ * player who moved first in the corner, or the other player, so the
+ * same joseki begun by black or by white is the same sequence.  Two
+ * moves of the same color in a row mean the other player played
+ * elsewhere (tenuki).
+ *
+ * The dictionary is a trie of these sequences: each node is a move,
+ * its children the moves that followed it, and each node counts the
+ * corners that went through it.  The root stands for an empty corner.
+ * It is built in memory (see j_learn), from any number of games, and
+ * written to a file in which the nodes are in breadth first order,
+ * with the children of each node together and sorted by their move
+ * codes, so they can be searched by halves.  That file is mapped into
+ * memory (read only, and shared with any other process that maps it)
+ * and used where it lies, so it costs nothing to load however large it
+ * is.  The file is in the byte order of the machine that built it.
+ */
+#define J_SPAN(size)	(((size) - 1) / 2)	/* lines from each edge */
+#define J_MAXLEN	32	/* most moves of a corner followed */
+#define J_MINGAMES	2	/* times a reply must have been played */
+#define J_DEFFILE	"go.jos" /* dictionary mapped when the program starts */
+#define J_MAGIC		"GOJOSEK1"
+
+/* move codes: where the move is in the (turned) corner, and whether it
+ * was made by the player who moved first there */
+#define J_CODE(x,y,other)	(((x) << 5 | (y)) << 1 | (other))
+#define J_X(code)		((code) >> 6)
+#define J_Y(code)		((code) >> 1 & 0x1f)
+#define J_OTHER(code)		((code) & 1)
+
+/* the dictionary file: a header, and then the nodes (the root first) */
+struct jheader
+{	char	j_magic[8];	/* J_MAGIC */
+	int	j_size;		/* size of the board the games were played on */
+	int	j_nnodes;	/* number of nodes */
+};
+
+struct jnode
+{	unsigned j_kids;	/* number of the first child */
+	unsigned short j_nkids;	/* number of children */
+	unsigned short j_move;	/* move code */
+	unsigned j_count;	/* corners that went through it */
+};
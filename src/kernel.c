@@ -0,0 +1,963 @@
+/*
+ * module:
+ *	kernel.c
+ *
+ * purpose:
+ *	the routines that carry out (and take back) moves, in a form that
+ *	can be compiled separately for each board size of interest.
+ *
+ * note:
+ *	this file is not compiled by itself.  It is included by engine.c
+ *	(once for each engine), which first defines:
+ *		K_NAME(f)	name of routine f in this engine
+ *		K_SIZE(gp)	number of lines on the board
+ *		K_WORDS(gp)	number of words in a liberty set
+ *		K_FOLD(gp)	influence folding function (see influenc.c)
+ *		K_LIGHT		1 for a light engine, 0 for a full one
+ *	For an engine built for one size of board these are constants, so
+ *	the compiler can fix every loop bound and table at compile time; for
+ *	the general engine they come from the game context.
+ *
+ *	A light engine (used for playouts, see playout.c) keeps only the
+ *	string and pattern boards, liberties, hash and prisoner counts up
+ *	to date (and the large pattern hashes, when asked to, see
+ *	pattern.h).  It does no display, tracing, influence, region or
+ *	superko bookkeeping, so a move made by a light engine must be
+ *	taken back by the same engine.
+ */
+#define K_SHOW(gp)	(!K_LIGHT && !(gp)->g_fantasy)
+#define K_TRACING(gp,m)	(!K_LIGHT && TRACING( gp, m ))
+
+/*
+ * routine:
+ *	l_clear, l_merge
+ *
+ * purpose:
+ *	to empty a liberty set, and to merge one set into another
+ *
+ * note:
+ *	these are the same as the routines in libs.c, except that the
+ *	width of the sets is known here.
+ */
+static void K_NAME(l_clear)( struct game_ctx *gp, struct move *mp )
+{	register lword_t *sp;
+	register int i;
+
+	if (mp->m_libset == 0)
+	{	l_clear( gp, mp );
+		return;
+	}
+
+	for( sp = mp->m_libset, i = 0; i < K_WORDS(gp); i++ )
+		sp[i] = 0;
+	mp->m_libs = 0;
+}
+
+static int K_NAME(l_merge)( struct game_ctx *gp, struct move *np, struct move *op )
+{	register lword_t *sp = np->m_libset;
+	register lword_t *xp = op->m_libset;
+	register int i, count = 0;
+
+	for( i = 0; i < K_WORDS(gp); i++ )
+	{	sp[i] |= xp[i];
+		count += L_COUNT( sp[i] );
+	}
+
+	np->m_libs = count;
+	return( count );
+}
+
+/*
+ * routine:
+ *	delta_inf
+ *
+ * purpose:
+ *	to add (or take away) the influence of a stone
+ *
+ * parms:
+ *	game in which the stone is being placed or removed
+ *	point at which the stone is found
+ *	color of stone being placed or removed
+ *	number of stones being placed (1,-1)
+ *
+ * note:
+ *	a stone that is at least four lines from every edge has no part
+ *	of its influence function folded back, so we can add the function
+ *	directly to the block of points around it.  Others go through the
+ *	folding function, as in influenc.c.
+ */
+#if !K_LIGHT
+static void K_NAME(delta_inf)( struct game_ctx *gp, int pt, unsigned color, int new )
+{	register int i, j;
+	register short *rp;
+	register int *fold;
+	int row = P_ROW( pt );
+	int col = P_COL( pt );
+	int sign = (color == WHITE) ? new : -new;
+
+	if (row >= 4  &&  row <= K_SIZE(gp) - 3  &&
+	    col >= 4  &&  col <= K_SIZE(gp) - 3)
+	{	rp = &gp->g_inf[ pt - 3*P_STRIDE - 3 ];
+		if (sign > 0)
+			for( i = 0; i < 7; i++, rp += P_STRIDE )
+				for( j = 0; j < 7; j++ )
+					rp[j] += inf_func[i][j];
+		else
+			for( i = 0; i < 7; i++, rp += P_STRIDE )
+				for( j = 0; j < 7; j++ )
+					rp[j] -= inf_func[i][j];
+		return;
+	}
+
+	fold = K_FOLD(gp);
+	for( i = 0; i < 7; i++ )
+	{	rp = &gp->g_inf[ P_INDEX( fold[ row+i ], 0 ) ];
+		for( j = 0; j < 7; j++ )
+			rp[fold[col+j]] += sign * inf_func[i][j];
+	}
+}
+#endif
+
+#if !K_LIGHT
+/*
+ * routine:
+ *	e_link, e_unlink
+ *
+ * purpose:
+ *	to put a point into a region's ring, and to take it out again
+ *
+ * parameters:
+ *	game in which the region is found
+ *	point to be linked in (or out)
+ *	number of the region (e_link only)
+ */
+static void K_NAME(e_link)( struct game_ctx *gp, int pt, int r )
+{	register struct region *rp = &gp->g_region[r];
+	register int q;
+
+	gp->g_rgn[pt] = r;
+	if (rp->e_size++ == 0)
+	{	rp->e_point = pt;
+		gp->g_rnext[pt] = gp->g_rprev[pt] = pt;
+		return;
+	}
+	q = rp->e_point;
+	gp->g_rnext[pt] = gp->g_rnext[q];
+	gp->g_rprev[pt] = q;
+	gp->g_rprev[ gp->g_rnext[q] ] = pt;
+	gp->g_rnext[q] = pt;
+}
+
+static void K_NAME(e_unlink)( struct game_ctx *gp, int pt )
+{	register struct region *rp = &gp->g_region[ gp->g_rgn[pt] ];
+
+	gp->g_rnext[ gp->g_rprev[pt] ] = gp->g_rnext[pt];
+	gp->g_rprev[ gp->g_rnext[pt] ] = gp->g_rprev[pt];
+	if (rp->e_point == pt)
+		rp->e_point = gp->g_rnext[pt];
+	rp->e_size--;
+}
+
+/*
+ * routine:
+ *	e_clear
+ *
+ * purpose:
+ *	to put a point that has just been vacated into a region
+ *
+ * parameters:
+ *	game in which the stone was removed
+ *	point from which it was removed
+ *	color of the stone
+ *
+ * note:
+ *	the point joins the largest region next to it (or a new region
+ *	of its own), and any other regions next to it are merged into
+ *	that one, by relabeling their points and splicing their rings in.
+ */
+static void K_NAME(e_clear)( struct game_ctx *gp, int pt, unsigned color )
+{	register struct string *sp = &gp->g_str[pt];
+	register struct region *rp, *op;
+	register const int *ap;
+	register int q;
+	int r, o, a, b, touch[2];
+
+	/* find the largest region next to it, and count the stones it
+	 * touches and the points whose stone it was */
+	r = -1;
+	touch[BLACK] = touch[WHITE] = 0;
+	for( ap = k_adj; ap < &k_adj[4]; ap++ )
+		if (sp[*ap].s_moveno > 0)
+			touch[ (int) sp[*ap].s_color ]++;
+		else if (sp[*ap].s_moveno == 0)
+		{	touch[color]--;
+			o = gp->g_rgn[ pt + *ap ];
+			if (r < 0  ||  gp->g_region[o].e_size > gp->g_region[r].e_size)
+				r = o;
+		}
+	if (r < 0)
+	{	r = gp->g_rfree[ --gp->g_nrfree ];
+		rp = &gp->g_region[r];
+		rp->e_size = 0;
+		rp->e_touch[BLACK] = rp->e_touch[WHITE] = 0;
+	} else
+		rp = &gp->g_region[r];
+	K_NAME(e_link)( gp, pt, r );
+
+	/* merge the others into it */
+	for( ap = k_adj; ap < &k_adj[4]; ap++ )
+	{	if (sp[*ap].s_moveno != 0  ||  (o = gp->g_rgn[ pt + *ap ]) == r)
+			continue;
+		op = &gp->g_region[o];
+		q = op->e_point;
+		do
+		{	gp->g_rgn[q] = r;
+			q = gp->g_rnext[q];
+		} while( q != op->e_point );
+
+		a = rp->e_point;
+		b = op->e_point;
+		q = gp->g_rnext[a];
+		gp->g_rnext[a] = gp->g_rnext[b];
+		gp->g_rprev[ gp->g_rnext[b] ] = a;
+		gp->g_rnext[b] = q;
+		gp->g_rprev[q] = b;
+
+		rp->e_size += op->e_size;
+		rp->e_touch[BLACK] += op->e_touch[BLACK];
+		rp->e_touch[WHITE] += op->e_touch[WHITE];
+		gp->g_rfree[ gp->g_nrfree++ ] = o;
+	}
+
+	rp->e_touch[BLACK] += touch[BLACK];
+	rp->e_touch[WHITE] += touch[WHITE];
+}
+
+/*
+ * routine:
+ *	e_fill
+ *
+ * purpose:
+ *	to take a point that has just been given a stone out of its region
+ *
+ * parameters:
+ *	game in which the stone was placed
+ *	point at which it was placed
+ *	color of the stone
+ *
+ * note:
+ *	the region is split if the stone cut it in two.  If the vacant
+ *	points next to the stone are all connected through the eight
+ *	points around it, it cannot have been.  Otherwise the region is
+ *	searched from all of them at once, so that only the smaller parts
+ *	are searched out completely.
+ */
+static void K_NAME(e_fill)( struct game_ctx *gp, int pt, unsigned color )
+{	register struct string *sp = &gp->g_str[pt];
+	register struct region *rp, *op;
+	register const int *ap;
+	register int q, k;
+	int r, o, i, j, g, c, f, n, mark, live, nfound;
+	short vacant[4], group[4], left[4];
+	short found[ MAXBOARD * MAXBOARD ];
+
+	r = gp->g_rgn[pt];
+	rp = &gp->g_region[r];
+	K_NAME(e_unlink)( gp, pt );
+
+	/* the stones next to it lose a point, and the points gain a stone */
+	n = 0;
+	for( ap = k_adj; ap < &k_adj[4]; ap++ )
+	{	if (sp[*ap].s_moveno > 0)
+			rp->e_touch[ (int) sp[*ap].s_color ]--;
+		else if (sp[*ap].s_moveno == 0)
+		{	rp->e_touch[color]++;
+			vacant[ n++ ] = pt + *ap;
+		}
+	}
+
+	if (rp->e_size == 0)
+	{	gp->g_rfree[ gp->g_nrfree++ ] = r;
+		return;
+	}
+	if (n < 2)
+		return;
+
+	/* the stone cannot have cut it if they are joined around it */
+	for( i = k = 0; i < 8; i++ )
+		k |= (sp[ k_ring[i] ].s_moveno != 0) << i;
+	if (!k_cuts[k])
+		return;
+
+	/* search out the parts of the region around the neighbors all at
+	 * once, breadth first, joining the searches that meet; a search
+	 * that runs out of points has found a region of its own, and is
+	 * moved to one (unless it is the last one left) */
+	if (gp->g_rgen > E_MAXGEN)
+	{	for( q = 0; q < P_POINTS; q++ )
+			gp->g_rmark[q] = 0;
+		gp->g_rgen = 0;
+	}
+	mark = gp->g_rgen + 1;
+	gp->g_rgen += 4;
+	for( i = 0; i < n; i++ )
+	{	gp->g_rmark[ vacant[i] ] = mark + i;
+		found[i] = vacant[i];
+		group[i] = i;
+		left[i] = 1;
+	}
+	nfound = live = n;
+	for( f = 0; live > 1; f++ )
+	{	q = found[f];
+		g = group[ gp->g_rmark[q] - mark ];
+		for( ap = k_adj; ap < &k_adj[4]; ap++ )
+		{	if (gp->g_str[ q + *ap ].s_moveno != 0)
+				continue;
+			k = gp->g_rmark[ q + *ap ] - mark;
+			if (k < 0  ||  k >= 4)
+			{	gp->g_rmark[ q + *ap ] = mark + g;
+				found[ nfound++ ] = q + *ap;
+				left[g]++;
+			} else if ((o = group[k]) != g)
+			{	for( j = 0; j < n; j++ )
+					if (group[j] == o)
+						group[j] = g;
+				left[g] += left[o];
+				live--;
+			}
+		}
+		if (--left[g] > 0  ||  live < 2)
+			continue;
+
+		o = gp->g_rfree[ --gp->g_nrfree ];
+		op = &gp->g_region[o];
+		op->e_size = 0;
+		op->e_touch[BLACK] = op->e_touch[WHITE] = 0;
+		for( i = 0; i < nfound; i++ )
+		{	q = found[i];
+			if (group[ gp->g_rmark[q] - mark ] != g)
+				continue;
+			K_NAME(e_unlink)( gp, q );
+			K_NAME(e_link)( gp, q, o );
+			for( ap = k_adj; ap < &k_adj[4]; ap++ )
+				if (gp->g_str[ q + *ap ].s_moveno > 0)
+				{	c = gp->g_str[ q + *ap ].s_color;
+					op->e_touch[c]++;
+					rp->e_touch[c]--;
+				}
+		}
+		for( j = 0; j < n; j++ )
+			if (group[j] == g)
+				group[j] = -1;
+		live--;
+	}
+}
+#endif
+
+/*
+ * routine:
+ *	x_flip
+ *
+ * purpose:
+ *	to put a stone into (or take it out of) the pattern codes of the
+ *	points around it
+ *
+ * parameters:
+ *	game in which the stone is placed or removed
+ *	point at which it is found
+ *	color of the stone
+ *
+ * note:
+ *	the point's state in each code is vacant (all zeros) without the
+ *	stone, so the same exclusive or puts it in and takes it out.
+ */
+static void K_NAME(x_flip)( struct game_ctx *gp, int pt, unsigned color )
+{	register unsigned long *xp = &gp->g_pat[pt];
+	register unsigned long bits = X_STONE( color );
+	register int i;
+
+	for( i = 0; i < 8; i++ )
+		xp[ k_ring[i] ] ^= bits << X_SHIFT( (i + 4) & 7 );
+}
+
+/*
+ * routine:
+ *	m_splice
+ *
+ * purpose:
+ *	to join (or split) the stone rings through two points
+ *
+ * parameters:
+ *	game in which the rings are found
+ *	point of a stone in the first ring
+ *	point of a stone in the second ring
+ *
+ * note:
+ *	exchanging the two links joins two distinct rings into one, and
+ *	splits a single ring (containing both points) into two.  Since the
+ *	exchange is its own inverse, a string is taken apart by repeating
+ *	the splices that built it, last first.
+ */
+static void K_NAME(m_splice)( struct game_ctx *gp, int a, int b )
+{	register struct string *ap = &gp->g_str[a];
+	register struct string *bp = &gp->g_str[b];
+	register short t;
+
+	t = ap->s_next;
+	ap->s_next = bp->s_next;
+	bp->s_next = t;
+}
+
+/*
+ * routine:
+ *	m_zap
+ *
+ * purpose:
+ *	to remove (from the string board) all of the stones in a killed string
+ *
+ * parameters:
+ *	game in which the kill is taking place
+ *	root of the string to be killed
+ *
+ * returns:
+ *	number of liberties gained by killer
+ *
+ * note:
+ *	the stones are visited by walking around the string's ring, which
+ *	we leave intact so that m_restore can walk it again
+ */
+static int K_NAME(m_zap)( struct game_ctx *gp, struct move *mp )
+{	register struct string *sp;
+	register const int *ap;
+	register int pt;
+	int newlibs = 0;
+	unsigned color = mp->m_flags & M_COLOR;
+
+	pt = mp->m_point;
+	do
+	{	/* take this stone off of the string board */
+		sp = &gp->g_str[pt];
+		sp->s_moveno = 0;
+#if !K_LIGHT
+		K_NAME(e_clear)( gp, pt, color );
+#endif
+		K_NAME(x_flip)( gp, pt, color );
+		if (gp->g_qon)
+			q_flip( gp, pt, color );
+
+		/* credit the kill for score purposes */
+		if (color == BLACK)
+			gp->g_wkills++;
+		else
+			gp->g_bkills++;
+
+		/* note, also, the influence implications of this removal */
+#if !K_LIGHT
+		K_NAME(delta_inf)( gp, pt, color, -1 );
+#endif
+
+		/* take it off of the display board */
+		if (K_SHOW( gp ))
+			b_remove( gp, P_ROW( pt ), P_COL( pt ) ); 
+		gp->g_vacancies++;
+		gp->g_hash ^= Z_STONE( color, pt );
+
+		/*
+		 * cycle through the neighbors' string table entries to
+		 * find out which ones are hostiles who benefit from its demise
+		 */
+		for( ap = k_adj; ap < &k_adj[4]; ap++ )
+		{	if (sp[*ap].s_moveno > 0  &&  sp[*ap].s_color != color)
+				newlibs += l_gain( gp, MOVE( gp, sp[*ap].s_moveno ), pt );
+		}
+
+		pt = sp->s_next;
+	} while( pt != mp->m_point );
+
+	return( newlibs );
+}
+
+/*
+ * routine:
+ *	m_restore
+ *
+ * purpose:
+ *	to restore (to the string board) a previously dead string
+ *
+ * parameters:
+ *	game in which the kill is being rescinded
+ *	root of the string to be restored to the board
+ *	move number of the string's root
+ *	move number of the group that originally killed it 
+ *
+ * returns:
+ *	void
+ *
+ * note:
+ *	since we know the killer will disappear soon, we can save ourselves
+ *	the work of impinging upon his liberties as our stones reappear
+ */
+static void K_NAME(m_restore)( struct game_ctx *gp, struct move *mp, int value, int killer )
+{	register struct string *sp;
+	register const int *ap;
+	register int pt;
+	unsigned color = mp->m_flags & M_COLOR;
+
+	pt = mp->m_point;
+	do
+	{	/* replace this stone on the display board */
+		sp = &gp->g_str[pt];
+		if (K_SHOW( gp ))
+			(void)b_set( gp, P_ROW( pt ), P_COL( pt ), 
+				color, B_NORMAL, B_NORMAL, sp->s_stone );
+		gp->g_vacancies--;
+		gp->g_hash ^= Z_STONE( color, pt );
+
+		/* un-credit the kill */
+		if (color == BLACK)
+			gp->g_wkills--;
+		else
+			gp->g_bkills--;
+
+		/* note the influence implications of this replacement */
+#if !K_LIGHT
+		K_NAME(delta_inf)( gp, pt, color, 1 );
+#endif
+
+		/*
+		 * cycle through the neighbors' string table entries to
+		 * find out which ones are hostiles on whom it will impinge
+		 */
+		for( ap = k_adj; ap < &k_adj[4]; ap++ )
+		{	if (sp[*ap].s_moveno > 0  &&  sp[*ap].s_color != color 
+						  &&  sp[*ap].s_moveno != killer)
+				(void) l_lose( gp, MOVE( gp, sp[*ap].s_moveno ), pt );
+		}
+
+		/* re-label its position on the string board */
+		sp->s_moveno = value;
+		sp->s_color = color;
+#if !K_LIGHT
+		K_NAME(e_fill)( gp, pt, color );
+#endif
+		K_NAME(x_flip)( gp, pt, color );
+		if (gp->g_qon)
+			q_flip( gp, pt, color );
+
+		pt = sp->s_next;
+	} while( pt != mp->m_point );
+}
+
+/*
+ * routine:
+ *	m_label
+ *
+ * purpose:
+ *	to label (on the string board) all of the stones in a ring
+ *
+ * parameters:
+ *	game in which the ring is found
+ *	point of any stone in the ring
+ *	move number of the string description node
+ *
+ * returns:
+ *	void
+ */
+static void K_NAME(m_label)( struct game_ctx *gp, int pt, int value )
+{	register struct string *sp;
+	register int p = pt;
+
+	do
+	{	sp = &gp->g_str[p];
+		sp->s_moveno = value;
+		p = sp->s_next;
+	} while( p != pt );
+}
+
+/*
+ * routine:
+ *	m_estimate
+ *
+ * purpose:
+ *	to estimate the implications of a move
+ *
+ * parameters:
+ *	game in which the move is to be made
+ *	pointer to move struct for move to be estimated
+ *		it is assumed that the m_pos field has been initialized
+ *		to the position of the move, and that m_flags has been
+ *		set to the color of stone being placed.
+ *
+ * notes:
+ *	the m_libs count in the returned move structure does not
+ *	include liberties that may be gained from kills - although
+ *	there will surely be somewhere between m_gkills and m_kills
+ *	liberties gained.  The m_netlib count does, however, include
+ *	a rough estimate of the number of liberties to be gained from
+ *	kills.  The actual determination of gained liberties is complex 
+ *	and cannot be made without enumerating all of the neighbors of 
+ *	all of the stones in the doomed groups.  This computation is
+ *	too expensive for a cheap estimator, and will not be performed
+ *	until m_do.  
+ */
+static void K_NAME(m_estimate)( struct game_ctx *gp, struct move *mp )
+{	unsigned char color = mp->m_flags & M_COLOR;	/* color making move */
+	register const int *ap;		/* pointer to neighbor offsets */
+	register struct string *sp;	/* pointer into string board */
+	register struct move *op;	/* pointer to neighbor move node */
+	int m;				/* move number being considered */
+	short *np;			/* pointer into m_neighbor array */
+	int pt;				/* point at which move is made */
+
+	/* start by initializing the move description */
+	mp->m_stones = 1;
+	mp->m_libs = 0;
+	mp->m_netlib = 0;
+	mp->m_ataris = 0;
+	mp->m_kills = 0;
+	mp->m_gkills = 0;
+	mp->m_hurts = 0;
+	mp->m_ko.row_col = 0;
+	mp->m_neighbor[0] = 0; mp->m_neighbor[1] = 0; 
+	mp->m_neighbor[2] = 0; mp->m_neighbor[3] = 0;
+	mp->m_eyes = 0;	/* pity about this not being implemented */
+	K_NAME(l_clear)( gp, mp );	/* start with an empty liberty set */
+
+	/*
+	 * figure out where I am on the board, and then
+	 * cycle through my neighbor's string table entries to
+	 * find out about my liberties, friends and ememies
+	 */
+	mp->m_point = pt = P_POINT( mp->m_pos );
+	np = mp->m_neighbor;
+	for( ap = k_adj; ap < &k_adj[4]; ap++ )
+	{	/* find the next neighbor in the string table */
+		sp = &gp->g_str[ pt + *ap ];
+		if ((m = sp->s_moveno) == 0)
+		{	/* liberties should be added to this group */
+			(void) l_gain( gp, mp, pt + *ap );
+		} else if (m > 0)
+		{	/* determine whether it is hostile or friendly */
+			op = MOVE( gp, m );
+			if (sp->s_color == color)
+			{	/* friendly group - make sure its a new one */
+				if (mp->m_stones > 1)
+				{	if (mp->m_neighbor[0] == m)
+						continue;
+					if (mp->m_neighbor[1] == m)
+						continue;
+					if (mp->m_neighbor[2] == m)
+						continue;
+				}
+
+				/*
+				 * not already known, set up the merge
+				 * note that we subtract each groups liberties
+				 * from m_netlib, because that is the number
+				 * of liberties we started with.
+				 */
+				mp->m_stones += op->m_stones;
+				mp->m_netlib -= op->m_libs;
+				*np++ = m;
+				(void) K_NAME(l_merge)( gp, mp, op );
+			} else
+			{	/* hostile group - make sure its a new one */
+				m *= -1;
+				if (mp->m_hurts > 0)
+				{	if (mp->m_neighbor[0] == m)
+						continue;
+					if (mp->m_neighbor[1] == m)
+						continue;
+					if (mp->m_neighbor[2] == m)
+						continue;
+				}
+
+				/* not already known, set up the impingement */
+				if (op->m_libs == 1)
+				{	/* we will kill this group */
+					mp->m_kills += op->m_stones;
+					mp->m_gkills++;
+					mp->m_ko.row_col = op->m_pos.row_col;
+				} else if (op->m_libs == 2)
+				{	/* we will atari this group */
+					if (mp->m_ataris)
+						mp->m_flags |= M_MULTIPLE;
+					mp->m_ataris += op->m_stones;
+				}
+				*np++ = m;
+				mp->m_hurts++;
+			}
+		}
+	}
+
+	/* in a merge, there is a danger of counting myself as a liberty */
+	if (mp->m_stones > 1)
+		(void) l_lose( gp, mp, pt );
+
+	/* add new groups liberties to the (probably negative) net */
+	mp->m_netlib += mp->m_libs;
+
+	/*
+	 * Hazzard a crude estimate at the liberties gained by our kills.
+	 *
+	 * The heuristic hand waving says that a kill of four or fewer
+	 * stones probably buys as many liberties for the killer.  In a
+	 * larger group, some of the corpses may have been interior and
+	 * will not buy any liberties for the killer.  We claim that about
+	 * one third of the points in a large group are internal.
+	 */
+	mp->m_netlib += (mp->m_kills < 5) ? mp->m_kills
+					  : (((mp->m_kills + 1) << 1) / 3);
+
+	/* 
+	 * we have noted the position of the last killed neighbor in m_ko.
+	 * If this isn't really a ko situation, we should clear m_ko.
+	 */
+	if (mp->m_libs != 0  ||  mp->m_stones != 1  ||  mp->m_kills != 1)
+		mp->m_ko.row_col = 0;
+
+	/* see if it is patently foolish */
+	if (mp->m_libs < 2  &&  mp->m_kills == 0)
+		mp->m_flags |= M_BLUNDER;
+
+	/*
+	 * If I really want alot of output, I can log all estimates 
+	 */
+	if (K_TRACING( gp, D_est ))
+	{      fprintf(dbglog,"ESTIMATE #%d %c %c%d: kill %d, atari %d, lib +%d\n",
+			mp->m_num, mp->m_flags & M_COLOR ? 'w' : 'b', 
+			COLNAME( mp->m_pos.sub.col ), mp->m_pos.sub.row, 
+			mp->m_kills, mp->m_ataris, mp->m_netlib );
+		if (K_TRACING( gp, D_affected ))
+		for( np = mp->m_neighbor; *np && np < &mp->m_neighbor[4]; np++ )
+		{	if (*np > 0)
+			{	op = MOVE( gp, *np );
+				fprintf( dbglog, "    ABSORB %c%d, %d stones\n",
+				    COLNAME( op->m_pos.sub.col ), op->m_pos.sub.row, 
+				    op->m_stones );
+			} else
+			{	op = MOVE( gp, -(*np) );
+				fprintf( dbglog, "    ATTACK %c%d, %d stones\n",
+				    COLNAME( op->m_pos.sub.col ), op->m_pos.sub.row, 
+				    op->m_stones );
+			}
+		}
+	}
+}
+
+/*
+ * routine:
+ *	m_do
+ *
+ * purpose:
+ *	to carry out the implications of a previously estimated move
+ *
+ * parameters:
+ *	game in which the move is to be made
+ *	pointer to move to be carried out (as filled out by m_estimate)
+ *
+ * returns:
+ *	void
+ *
+ * notes:
+ *	the m_libs count in the estimate includes all liberties in the
+ *	(soon-to-be) subsumed groups, but does not include any of the 
+ *	liberties that may be gained from kills.
+ *
+ *	since this is the routine that actually performs moves, it is
+ *	our responsibility to see that the display board gets updated.
+ *	This routine, and the routines under it, will refrain from
+ *	updating the display board if the "fantasy move" flag is
+ *	set in the game - indicating that we are performing tactical
+ *	analysis rather than real moves.
+ */
+static void K_NAME(m_do)( struct game_ctx *gp, struct move *mp )
+{	register struct move *np;
+	register short *sp;
+	register short s;
+	register struct string *psp;
+	int pt = mp->m_point;
+
+	/* note whether this move keeps the pattern hashes (see pattern.h) */
+	if (gp->g_qpat  &&  (!K_LIGHT  ||  gp->g_qtrack))
+		mp->m_flags |= M_PATTERN;
+	else
+		mp->m_flags &= ~M_PATTERN;
+	gp->g_qon = mp->m_flags & M_PATTERN;
+
+	/* note the placement of a new stone on the display board */
+	if (K_SHOW( gp ))
+		(void)b_set( gp, mp->m_pos.sub.row, mp->m_pos.sub.col, 
+			mp->m_flags&M_COLOR, B_NORMAL, B_NORMAL, mp->m_num);
+	gp->g_vacancies--;
+	gp->g_hash ^= Z_STONE( mp->m_flags&M_COLOR, pt );
+
+	/* the new stone starts out as a ring of its own */
+	psp = &gp->g_str[pt];
+	mp->m_oldnext = psp->s_next;
+	mp->m_oldstone = psp->s_stone;
+	psp->s_next = pt;
+	psp->s_stone = mp->m_num;
+	psp->s_color = mp->m_flags & M_COLOR;
+
+	/* coalesce all of the subsumed stones into a single string */
+	for( sp = mp->m_neighbor; (sp < &mp->m_neighbor[4]) && (s = *sp++); )
+		if (s > 0)
+			K_NAME(m_splice)( gp, pt, MOVE( gp, s )->m_point );
+	K_NAME(m_label)( gp, pt, mp->m_num );
+#if !K_LIGHT
+	K_NAME(e_fill)( gp, pt, psp->s_color );
+#endif
+	K_NAME(x_flip)( gp, pt, psp->s_color );
+	if (gp->g_qon)
+		q_flip( gp, pt, psp->s_color );
+
+	/* reset m_netlib to estimaged gains from kills, so we can check est */
+	mp->m_netlib = -( mp->m_gkills );
+
+	/* examine the damage done to adjacent opposing strings */
+	for( sp = mp->m_neighbor; (sp < &mp->m_neighbor[4]) && (s = *sp++); )
+	{	if (s < 0)
+		{	/* a hostile neighbor to impinge upon, maybe kill */
+			np = MOVE( gp, -s );
+			if (l_lose( gp, np, pt )  &&  np->m_libs == 0)
+			{	mp->m_netlib += K_NAME(m_zap)( gp, np );
+
+				if (K_TRACING( gp, D_kills ))
+				{      fprintf( dbglog,
+						"KILL %c %c%d: %d stones\n",
+						np->m_flags&M_COLOR ? 'w' : 'b',
+						COLNAME( np->m_pos.sub.col ), 
+						np->m_pos.sub.row, 
+						np->m_stones );
+				}
+			}
+		}
+	}
+
+#if !K_LIGHT
+	/* note, also, the influence implications of this move */
+	K_NAME(delta_inf)( gp, pt, mp->m_flags&M_COLOR, 1 );
+
+	/* and remember the position we have created */
+	k_add( gp, gp->g_hash );
+#endif
+}
+
+/*
+ * routine:
+ *	m_unmove
+ *
+ * purpose:
+ *	to rescind a previously made move
+ *
+ * parameters:
+ *	game in which the move was made
+ *	pointer to move to be rescinded
+ *
+ * returns:
+ *	void
+ *
+ * notes:
+ *	since this is the routine that actually performs moves, it is
+ *	our responsibility to see that the display board gets updated.
+ *	This routine, and the routines under it, will refrain from
+ *	updating the display board if the "fantasy move" flag is
+ *	set in the game - indicating that we are performing tactical
+ *	analysis rather than real moves.
+ */
+static void K_NAME(m_unmove)( struct game_ctx *gp, struct move *mp )
+{	register struct move *np;
+	register short *sp;
+	register short s;
+	register struct string *psp;
+	int pt = mp->m_point;
+
+#if !K_LIGHT
+	/* forget the position this move created */
+	k_remove( gp, gp->g_hash );
+#endif
+
+	/* it is taken back the way it was made */
+	gp->g_qon = mp->m_flags & M_PATTERN;
+
+	/* start by clearing the position occupied by the move */
+	psp = &gp->g_str[pt];
+	psp->s_moveno = 0;
+#if !K_LIGHT
+	K_NAME(e_clear)( gp, pt, mp->m_flags&M_COLOR );
+#endif
+	K_NAME(x_flip)( gp, pt, mp->m_flags&M_COLOR );
+	if (gp->g_qon)
+		q_flip( gp, pt, mp->m_flags&M_COLOR );
+	if (K_SHOW( gp ))
+		b_remove( gp, mp->m_pos.sub.row, mp->m_pos.sub.col );
+	gp->g_vacancies++;
+	gp->g_hash ^= Z_STONE( mp->m_flags&M_COLOR, pt );
+
+#if !K_LIGHT
+	/* note, also, the influence implications of this removal */
+	K_NAME(delta_inf)( gp, pt, mp->m_flags&M_COLOR, -1 );
+#endif
+
+	if (K_TRACING( gp, D_moves ))
+	{	fprintf(dbglog,
+			"LOG UNMOVE #%d %c %c%d: un-kill %d, un-atari %d\n",
+			mp->m_num, mp->m_flags & M_COLOR ? 'w' : 'b', 
+			COLNAME( mp->m_pos.sub.col ), mp->m_pos.sub.row, 
+			mp->m_kills, mp->m_ataris );
+	}
+
+	/* examine the damage done to adjacent opposing strings */
+	for( sp = mp->m_neighbor; (sp < &mp->m_neighbor[4]) && (s = *sp++); )
+	{	if (s < 0)
+		{	/* a hostile neighbor regains a liberty or even life */
+			np = MOVE( gp, -s );
+			if (K_TRACING( gp, D_affected ))
+			{    fprintf( dbglog, "    RETREAT %c%d, %d stones\n",
+				    COLNAME( np->m_pos.sub.col ), np->m_pos.sub.row, 
+				    np->m_stones );
+			}
+			if (l_gain( gp, np, pt )  &&  np->m_libs == 1)
+			{	K_NAME(m_restore)( gp, np, -s, mp->m_num );
+				if (K_TRACING( gp, D_kills ))
+				{      fprintf( dbglog,
+						"UNKILL %c %c%d: %d stones\n",
+						np->m_flags&M_COLOR ? 'w' : 'b',
+						COLNAME( np->m_pos.sub.col ), 
+						np->m_pos.sub.row, 
+						np->m_stones );
+				}
+			}
+		}
+	}
+
+	/* split the subsumed rings back out of ours, in reverse order */
+	for( sp = &mp->m_neighbor[4]; sp > mp->m_neighbor; )
+		if ((s = *--sp) > 0)
+			K_NAME(m_splice)( gp, pt, MOVE( gp, s )->m_point );
+
+	/* and put back whatever was left under this stone */
+	psp->s_next = mp->m_oldnext;
+	psp->s_stone = mp->m_oldstone;
+
+	/* return all subsumed groups to individuality */
+	for( sp = mp->m_neighbor; (sp < &mp->m_neighbor[4]) && (s = *sp++); )
+	{	if (s > 0)
+		{	K_NAME(m_label)( gp, MOVE( gp, s )->m_point, s );
+			if (K_TRACING( gp, D_affected ))
+			{	np = MOVE( gp, s );
+				fprintf( dbglog, "    FRAGMENT %c%d, %d stones\n",
+				    COLNAME( np->m_pos.sub.col ), np->m_pos.sub.row, 
+				    np->m_stones );
+			}
+		}
+	}
+
+	/* free my liberty list */
+	l_free( gp, mp );
+
+}
+
+#undef K_SHOW
+#undef K_TRACING
@@ -0,0 +1,512 @@
+/*
+ * module:
+ *	ladder.c
+ *
+ * purpose:
+ *	to read out ladders: whether a string that is short of liberties
+ *	can be chased to its death, one atari after another
+ *
+ * note:
+ *	a ladder is read without making any moves in the game.  Instead,
+ *	the stones played in the ladder are laid over the board (in an
+ *	overlay array), and the chased string's liberties are kept in a
+ *	liberty set of its own, which grows as the string is extended, and
+ *	from which the points covered by the overlay are masked out.  Only
+ *	strings next to the stones played need be looked at, so reading a
+ *	long ladder costs little more than following its path.
+ *
+ *	The defender's moves are forced (the string has one liberty, and
+ *	must run there), and the attacker has two choices at each step
+ *	(which side to atari from), so the reading is a simple depth first
+ *	search for any line in which the string dies.  It is kept on an
+ *	explicit stack, rather than in recursive calls.  A line ends as
+ *	soon as the string gets three liberties, connects to enough
+ *	friends, or can capture one of the stones chasing it (any of which
+ *	is a ladder breaker).
+ *
+ *	Ko and the rare ladders in which capturing a chasing stone does
+ *	not save the string are not considered, and neither are escapes by
+ *	capturing stones that are not touching the string.  All of the
+ *	state is local, so ladders may be read by many threads at once.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+
+#define R_MAXFRAMES	(2 * MAXBOARD)	/* longest ladder read */
+#define R_MAXSTONES	(4 * MAXBOARD)	/* most stones laid in a ladder */
+#define R_MAXCHECKS	512	/* most chasing stones awaiting a check */
+#define R_MAXGIDS	32	/* most friendly strings joined */
+#define R_MAXWORK	200	/* most attacking moves tried in one ladder */
+#define R_SETWORDS	L_WORDS( P_POINTS )
+
+/* how a line of the ladder turns out */
+#define R_DEAD		0	/* the string is captured */
+#define R_ALIVE		1	/* the string gets away */
+#define R_ATARI		2	/* the string has two liberties again */
+
+/* the position the ladder has reached */
+struct ladder
+{	struct game_ctx *r_game;	/* the game being read */
+	int	r_color;		/* color of the chased string */
+	int	r_words;		/* words in a liberty set */
+	char	r_over[ P_POINTS ];	/* stones laid (color + 1) */
+	lword_t	r_occ[ R_SETWORDS ];	/* points covered by the overlay */
+	lword_t	r_libs[ R_SETWORDS ];	/* chased string's liberties */
+	short	r_added[ R_MAXSTONES ];	/* stones laid, in order */
+	int	r_nadded;
+	short	r_gids[ R_MAXGIDS ];	/* strings in the chased string */
+	int	r_ngids;
+	short	r_checks[ R_MAXCHECKS ];	/* chasing stones to check */
+	int	r_nchecks;
+};
+
+/* a point at which the attacker must choose, and what it has tried */
+struct frame
+{	lword_t	f_libs[ R_SETWORDS ];	/* chased string's liberties */
+	int	f_nadded;		/* stones laid */
+	int	f_ngids;		/* strings joined */
+	int	f_nchecks;		/* chasing stones to check */
+	int	f_from;			/* first of them to check */
+	short	f_choice[2];		/* the two liberties */
+	int	f_tried;		/* number of them tried */
+};
+
+/*
+ * routine:
+ *	r_count
+ *
+ * purpose:
+ *	to count the chased string's liberties
+ *
+ * parms:
+ *	ladder being read
+ *	where to put the lowest two liberties (or 0 - not needed)
+ *
+ * returns:
+ *	number of liberties (counting no further than three)
+ */
+static int r_count( struct ladder *lp, short *first )
+{	register lword_t w;
+	register int i, n;
+
+	for( i = n = 0; i < lp->r_words; i++ )
+		for( w = lp->r_libs[i] & ~lp->r_occ[i]; w; w &= w - 1 )
+		{	if (n < 2  &&  first)
+				first[n] = (i << L_WORDSHIFT) + L_LOWEST( w );
+			if (++n >= 3)
+				return( n );
+		}
+
+	return( n );
+}
+
+/*
+ * routine:
+ *	r_lay
+ *
+ * purpose:
+ *	to lay a stone on the overlay
+ *
+ * parms:
+ *	ladder being read
+ *	point at which the stone is laid
+ *	color of the stone
+ *
+ * returns:
+ *	TRUE	the stone was laid
+ *	FALSE	the ladder is too long to follow
+ */
+static int r_lay( struct ladder *lp, int pt, int color )
+{
+	if (lp->r_nadded >= R_MAXSTONES)
+		return( FALSE );
+
+	lp->r_over[pt] = color + 1;
+	lp->r_added[ lp->r_nadded++ ] = pt;
+	L_WORD( lp->r_occ, pt ) |= L_BIT( pt );
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	r_check
+ *
+ * purpose:
+ *	to note a chasing stone that may run short of liberties
+ *
+ * parms:
+ *	ladder being read
+ *	point of the stone
+ *
+ * note:
+ *	if there are too many to keep, the extras are simply not checked
+ */
+static void r_check( struct ladder *lp, int pt )
+{
+	if (lp->r_nchecks < R_MAXCHECKS)
+		lp->r_checks[ lp->r_nchecks++ ] = pt;
+}
+
+/*
+ * routine:
+ *	r_strlibs
+ *
+ * purpose:
+ *	to count the liberties of a chasing string, as the ladder has left it
+ *
+ * parms:
+ *	ladder being read
+ *	point of one of the string's stones
+ *
+ * returns:
+ *	number of liberties (counting no further than two)
+ *
+ * note:
+ *	the string may be made of stones on the board, stones laid in the
+ *	ladder, or both.  We gather up its stones, starting from those in
+ *	the overlay (whose liberties we find by looking) and those strings
+ *	on the board (whose liberty sets we already have).  Most chasing
+ *	strings have two liberties of their own, before anything else is
+ *	counted, and they are dealt with quickly.
+ */
+static int r_strlibs( struct ladder *lp, int pt )
+{	register struct game_ctx *gp = lp->r_game;
+	register struct string *sp;
+	register int i, j, q;
+	register lword_t w;
+	int enemy = !lp->r_color;
+	short pts[ R_MAXSTONES ];
+	short ids[ R_MAXGIDS ];
+	int npts = 0;
+	int nids = 0;
+	int more, n;
+	lword_t set[ R_SETWORDS ];
+
+	/* the stone (or board string) we start from may be enough */
+	if (lp->r_over[pt])
+	{	for( j = n = 0; j < 4; j++ )
+		{	q = pt + p_adj[j];
+			if (!lp->r_over[q]  &&  gp->g_str[q].s_moveno == 0  &&  ++n >= 2)
+				return( n );
+		}
+		pts[ npts++ ] = pt;
+	} else
+	{	ids[ nids++ ] = gp->g_str[pt].s_moveno;
+		for( i = n = 0; i < lp->r_words; i++ )
+			for( w = MOVE( gp, ids[0] )->m_libset[i] & ~lp->r_occ[i]; w; w &= w - 1 )
+				if (++n >= 2)
+					return( n );
+	}
+
+	for( i = 0; i < lp->r_words; i++ )
+		set[i] = 0;
+
+	do
+	{	/* look around the laid stones we know of */
+		for( i = 0; i < npts; i++ )
+			for( j = 0; j < 4; j++ )
+			{	q = pts[i] + p_adj[j];
+				sp = &gp->g_str[q];
+				if (lp->r_over[q] == enemy + 1)
+				{	for( n = 0; n < npts  &&  pts[n] != q; n++ )
+						;
+					if (n == npts  &&  npts < R_MAXSTONES)
+						pts[ npts++ ] = q;
+				} else if (lp->r_over[q])
+					continue;
+				else if (sp->s_moveno == 0)
+					L_WORD( set, q ) |= L_BIT( q );
+				else if (sp->s_moveno > 0  &&  sp->s_color == enemy)
+				{	for( n = 0; n < nids  &&  ids[n] != sp->s_moveno; n++ )
+						;
+					if (n == nids  &&  nids < R_MAXGIDS)
+						ids[ nids++ ] = sp->s_moveno;
+				}
+			}
+
+		/* and find any other laid stones touching its board strings */
+		more = FALSE;
+		for( i = 0; i < lp->r_nadded; i++ )
+		{	q = lp->r_added[i];
+			if (lp->r_over[q] != enemy + 1)
+				continue;
+			for( n = 0; n < npts  &&  pts[n] != q; n++ )
+				;
+			if (n < npts)
+				continue;
+			for( j = 0; j < 4; j++ )
+			{	sp = &gp->g_str[ q + p_adj[j] ];
+				if (lp->r_over[ q + p_adj[j] ]  ||  sp->s_moveno <= 0)
+					continue;
+				for( n = 0; n < nids  &&  ids[n] != sp->s_moveno; n++ )
+					;
+				if (n < nids  &&  npts < R_MAXSTONES)
+				{	pts[ npts++ ] = q;
+					more = TRUE;
+					break;
+				}
+			}
+		}
+	} while( more );
+
+	/* its liberties are those not covered by the overlay */
+	for( i = 0; i < nids; i++ )
+		for( j = 0; j < lp->r_words; j++ )
+			set[j] |= MOVE( gp, ids[i] )->m_libset[j];
+
+	for( i = n = 0; i < lp->r_words; i++ )
+		for( w = set[i] & ~lp->r_occ[i]; w; w &= w - 1 )
+			if (++n >= 2)
+				return( n );
+
+	return( n );
+}
+
+/*
+ * routine:
+ *	r_join
+ *
+ * purpose:
+ *	to add a friendly string on the board to the chased string
+ *
+ * parms:
+ *	ladder being read
+ *	move number of the string
+ */
+static void r_join( struct ladder *lp, int id )
+{	register struct game_ctx *gp = lp->r_game;
+	register lword_t *set = MOVE( gp, id )->m_libset;
+	register int i, pt, q;
+	int head;
+
+	for( i = 0; i < lp->r_ngids; i++ )
+		if (lp->r_gids[i] == id)
+			return;
+	if (lp->r_ngids < R_MAXGIDS)
+		lp->r_gids[ lp->r_ngids++ ] = id;
+
+	for( i = 0; i < lp->r_words; i++ )
+		lp->r_libs[i] |= set[i];
+
+	/* the string's enemies are now the chased string's enemies */
+	head = pt = MOVE( gp, id )->m_point;
+	do
+	{	for( i = 0; i < 4; i++ )
+		{	q = pt + p_adj[i];
+			if (gp->g_str[q].s_moveno > 0  &&
+			    gp->g_str[q].s_color != lp->r_color  &&  !lp->r_over[q])
+				r_check( lp, q );
+		}
+		pt = gp->g_str[pt].s_next;
+	} while( pt != head );
+}
+
+/*
+ * routine:
+ *	r_defend
+ *
+ * purpose:
+ *	to make the defender's move: capture a chasing stone, or run
+ *
+ * parms:
+ *	ladder being read (the chased string has one liberty)
+ *	first of the chasing stones that must be checked
+ *
+ * returns:
+ *	R_DEAD	the string cannot get away
+ *	R_ALIVE	the string has got away
+ *	R_ATARI	the string has run, and has two liberties
+ */
+static int r_defend( struct ladder *lp, int from )
+{	register struct game_ctx *gp = lp->r_game;
+	register struct string *sp;
+	register int i, q;
+	short lib[2];
+	int color = lp->r_color;
+
+	/* a chasing string in atari can be captured */
+	for( i = from; i < lp->r_nchecks; i++ )
+		if (r_strlibs( lp, lp->r_checks[i] ) == 1)
+			return( R_ALIVE );
+
+	/* otherwise, run */
+	if (r_count( lp, lib ) != 1  ||  !r_lay( lp, lib[0], color ))
+		return( R_ALIVE );
+	L_WORD( lp->r_libs, lib[0] ) &= ~L_BIT( lib[0] );
+
+	for( i = 0; i < 4; i++ )
+	{	q = lib[0] + p_adj[i];
+		sp = &gp->g_str[q];
+		if (lp->r_over[q] == color + 1)
+			continue;
+		else if (!lp->r_over[q]  &&  sp->s_moveno == 0)
+			L_WORD( lp->r_libs, q ) |= L_BIT( q );
+		else if (!lp->r_over[q]  &&  sp->s_moveno > 0  &&
+			 sp->s_color == color)
+			r_join( lp, sp->s_moveno );
+		else if (lp->r_over[q]  ||  sp->s_moveno > 0)
+		{	/* running may capture a string that had only this liberty */
+			if (r_strlibs( lp, q ) == 0)
+				return( R_ALIVE );
+			r_check( lp, q );
+		}
+	}
+
+	switch( r_count( lp, (short *) 0 ) )
+	{ case 0:
+	  case 1:
+		return( R_DEAD );
+	  case 2:
+		return( R_ATARI );
+	  default:
+		return( R_ALIVE );
+	}
+}
+
+/*
+ * routine:
+ *	r_push
+ *
+ * purpose:
+ *	to note a point at which the attacker must choose a liberty to take
+ *
+ * parms:
+ *	ladder being read (the chased string has two liberties)
+ *	stack of such points
+ *	number of frames on it
+ *	first of the chasing stones the defender must check
+ *
+ * returns:
+ *	TRUE	the frame has been pushed
+ *	FALSE	the ladder is too long to follow
+ */
+static int r_push( struct ladder *lp, struct frame *stack, int *nframes, int from )
+{	register struct frame *fp;
+	register int i;
+
+	if (*nframes >= R_MAXFRAMES)
+		return( FALSE );
+
+	fp = &stack[ (*nframes)++ ];
+	for( i = 0; i < lp->r_words; i++ )
+		fp->f_libs[i] = lp->r_libs[i];
+	fp->f_nadded = lp->r_nadded;
+	fp->f_ngids = lp->r_ngids;
+	fp->f_nchecks = lp->r_nchecks;
+	fp->f_from = from;
+	fp->f_tried = 0;
+	(void) r_count( lp, fp->f_choice );
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	r_ladder
+ *
+ * purpose:
+ *	to see whether a string can be captured in a ladder
+ *
+ * parms:
+ *	game in which the string is found
+ *	point of one of its stones
+ *
+ * returns:
+ *	TRUE	the string can be captured in a ladder
+ *	FALSE	it cannot (or it is not short of liberties, or the ladder
+ *		is too long or too complicated to read)
+ *
+ * note:
+ *	a string with one liberty is read with its owner to move (can it
+ *	run away?), and one with two liberties with its enemy to move (can
+ *	it be driven into a ladder?).
+ */
+int r_ladder( struct game_ctx *gp, int pt )
+{	register struct ladder *lp;
+	register struct frame *fp;
+	register int i, q;
+	struct move *mp;
+	struct ladder lad;
+	struct frame stack[ R_MAXFRAMES ];
+	int nframes = 0;
+	int work = 0;
+	int from, libs, a;
+
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( FALSE );
+	mp = MOVE( gp, gp->g_str[pt].s_moveno );
+	if ((libs = mp->m_libs) < 1  ||  libs > 2)
+		return( FALSE );
+
+	/* the ladder starts with the string as it stands */
+	lp = &lad;
+	lp->r_game = gp;
+	lp->r_color = gp->g_str[pt].s_color;
+	lp->r_words = gp->g_libwords;
+	memset( lp->r_over, 0, sizeof lp->r_over );
+	for( i = 0; i < lp->r_words; i++ )
+	{	lp->r_occ[i] = 0;
+		lp->r_libs[i] = 0;
+	}
+	lp->r_nadded = 0;
+	lp->r_ngids = 0;
+	lp->r_nchecks = 0;
+	r_join( lp, mp->m_num );
+
+	if (libs == 1)
+	{	from = lp->r_nchecks;
+		switch( r_defend( lp, 0 ) )
+		{ case R_DEAD:
+			return( TRUE );
+		  case R_ALIVE:
+			return( FALSE );
+		}
+		(void) r_push( lp, stack, &nframes, from );
+	} else
+		(void) r_push( lp, stack, &nframes, 0 );
+
+	/* try each of the attacker's choices, until one kills */
+	while( nframes > 0 )
+	{	fp = &stack[ nframes-1 ];
+		if (fp->f_tried >= 2  ||  work >= R_MAXWORK)
+		{	nframes--;
+			continue;
+		}
+
+		/* go back to where the attacker made this choice */
+		while( lp->r_nadded > fp->f_nadded )
+		{	q = lp->r_added[ --lp->r_nadded ];
+			lp->r_over[q] = 0;
+			L_WORD( lp->r_occ, q ) &= ~L_BIT( q );
+		}
+		for( i = 0; i < lp->r_words; i++ )
+			lp->r_libs[i] = fp->f_libs[i];
+		lp->r_ngids = fp->f_ngids;
+		lp->r_nchecks = fp->f_nchecks;
+
+		/* take one of the liberties (if that is legal) */
+		a = fp->f_choice[ fp->f_tried++ ];
+		work++;
+		if (!r_lay( lp, a, !lp->r_color ))
+			continue;
+		if (r_strlibs( lp, a ) == 0)
+			continue;
+		r_check( lp, a );
+
+		/* and see what the defender can do about it */
+		from = lp->r_nchecks;
+		switch( r_defend( lp, fp->f_from ) )
+		{ case R_DEAD:
+			return( TRUE );
+		  case R_ATARI:
+			(void) r_push( lp, stack, &nframes, from );
+			break;
+		}
+	}
+
+	return( FALSE );
+}
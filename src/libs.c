@@ -3,65 +3,147 @@
  *	libs.c
  *
  * purpose
- *	routines for the management and manipulation of liberty lists
+ *	routines for the management and manipulation of liberty sets
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "go.h"
 #include "move.h"
 #include "libs.h"
-
-struct libs *freelibs;	/* head of the chain ef liberty elements */
-int l_quota = MAXLIBS/4;	/* quota for liberty pillaging */
+#include "strings.h"
+#include "game.h"
 
 /*
  * routine:
  *	l_reset
  *
  * purpose:
- *	to (re-)initialize the free liberty list
+ *	to (re-)initialize the liberty arena
+ *
+ * parms:
+ *	game whose liberty arena is to be reset
+ *
+ * note:
+ *	the chunks that have already been allocated are kept, and will
+ *	be reused (in order) as the new game needs them.  The width of
+ *	the liberty sets depends on the size of the board, so this must
+ *	be called after the board size has been set.
  */
-void l_reset()
-{	register struct libs *lp;
-
-	/* reinitialize free liberty list to contain all lib nodes */
-	freelibs = 0;
-	for( lp = libs; lp < &libs[ MAXLIBS ]; lp++ )
-	{	lp->l_next = freelibs;
-		freelibs = lp;
-	}
+void l_reset( struct game_ctx *gp )
+{
+	/* sets must be wide enough to hold the highest numbered point */
+	gp->g_libwords = L_WORDS( P_INDEX( gp->g_size, gp->g_size ) + 1 );
 
-	/* we have not canibalized any liberties */
-	pillage = 0;
+	gp->g_curchunk = 0;
+	gp->g_libhigh = 0;
+	if (gp->g_nchunks > 0)
+	{	gp->g_libnext = gp->g_libchunk[0];
+		gp->g_libend = &gp->g_libnext[ LIBCHUNK ];
+	} else
+		gp->g_libnext = gp->g_libend = 0;
 }
 
 /*
  * routine:
- *	l_ransack
+ *	l_release
  *
  * purpose:
- *	to loot and pillage very old moves in order to reclaim liberties
+ *	to give back all of the memory in a game's liberty arena
  *
  * parms:
- *	number of liberties to be reclaimed
+ *	game whose arena is to be released
  */
-void l_ransack( int quota )
-{	register struct libs *lp, *np;
-	register struct move *mp;
-	register int needed = quota;
-
-	while( needed > 0 )
-	{	mp = &moves[ ++pillage ];
-		for( lp = mp->m_liblist; lp; lp = np )
-		{	np = lp->l_next;
-			lp->l_next = freelibs;
-			freelibs = lp;
-			needed--;
+void l_release( struct game_ctx *gp )
+{	register int i;
+
+	for( i = 0; i < gp->g_nchunks; i++ )
+		free( (char *) gp->g_libchunk[i] );
+	if (gp->g_libchunk)
+		free( (char *) gp->g_libchunk );
+
+	gp->g_libchunk = 0;
+	gp->g_nchunks = 0;
+	l_reset( gp );
+}
+
+/*
+ * routine:
+ *	l_carve
+ *
+ * purpose:
+ *	to carve a new liberty set out of the arena
+ *
+ * parms:
+ *	game whose arena the set is to come from
+ *
+ * returns:
+ *	pointer to the first word of the new set
+ *
+ * note:
+ *	the set comes from the unused part of the current chunk, moving
+ *	on to the next chunk (and allocating it, if we have never needed
+ *	it before) when there isn't enough left in the current one.
+ */
+static lword_t *l_carve( struct game_ctx *gp )
+{	register lword_t **cp;
+	register lword_t *sp;
+	register int n;
+
+	if (gp->g_libend - gp->g_libnext < gp->g_libwords)
+	{	n = (gp->g_libnext == 0) ? 0 : gp->g_curchunk + 1;
+		if (n >= gp->g_nchunks)
+		{	/* we need a new chunk, and maybe a bigger directory */
+			cp = (lword_t **) realloc( (char *) gp->g_libchunk,
+					(n + 1) * sizeof (lword_t *) );
+			if (cp == 0)
+				goto nomem;
+			gp->g_libchunk = cp;
+			cp[n] = (lword_t *) malloc( LIBCHUNK * sizeof (lword_t) );
+			if (cp[n] == 0)
+				goto nomem;
+			gp->g_nchunks = n + 1;
 		}
-		mp->m_liblist = 0;
+		gp->g_curchunk = n;
+		gp->g_libnext = gp->g_libchunk[n];
+		gp->g_libend = &gp->g_libnext[ LIBCHUNK ];
 	}
 
-	d_msg( "*** Pilaging liberties up to move %d, plundered %d",
-		pillage, quota - needed );
+	gp->g_libhigh++;
+	sp = gp->g_libnext;
+	gp->g_libnext += gp->g_libwords;
+	return( sp );
+
+nomem:
+	d_msg( "*** Unable to allocate more liberties" );
+	d_cleanup();
+	exit( -1 );
+	/*NOTREACHED*/
+}
+
+/*
+ * routine:
+ *	l_clear
+ *
+ * purpose:
+ *	to give a move an empty set of liberties
+ *
+ * parms:
+ *	game in which the move is being made
+ *	address of move node
+ *
+ * note:
+ *	this is the only place where liberty sets are allocated
+ */
+void l_clear( struct game_ctx *gp, struct move *mp )
+{	register lword_t *sp, *ep;
+
+	if (mp->m_libset == 0)
+		mp->m_libset = l_carve( gp );
+
+	ep = &mp->m_libset[ gp->g_libwords ];
+	for( sp = mp->m_libset; sp < ep; sp++ )
+		*sp = 0;
+	mp->m_libs = 0;
 }
 
 /*
@@ -72,44 +154,22 @@ void l_ransack( int quota )
  *	to add a liberty to a string
  *
  * parms:
+ *	game in which the string is found
  *	address of move node for beneficiary
- *	position to be added as a liberty
+ *	point to be added as a liberty
  *
  * returns:
  *	number of liberties gained (1/0)
- *
- * notes:
- *	to optimize searches, merges, and deletions, liberties lists
- *	are sorted in order of ascending positions.
  */
-int l_gain( struct move *mp, pos_t pos )
-{	register struct libs *lp, **pp;
+int l_gain( struct game_ctx *gp, struct move *mp, int pt )
+{	register lword_t *wp = &L_WORD( mp->m_libset, pt );
 
-	pp = &mp->m_liblist;
-	for( lp = *pp; lp; lp = *pp )
-	{	/* see if we found the liberty we're seeking */
-		if (lp->l_pos.row_col == pos.row_col)
-			return( 0 );
+	/* see if it is already one of our liberties */
+	if (*wp & L_BIT( pt ))
+		return( 0 );
 
-		/* see if we've reached where it should be */
-		if (lp->l_pos.row_col > pos.row_col)
-			break;
-
-		/* continue on down the list */
-		pp = &lp->l_next;
-	}
-
-	/* get a free liberty node */
-	if (freelibs == 0)
-		l_ransack( l_quota );
-	*pp = freelibs;
-	freelibs = freelibs->l_next;
-
-	/* label it with the position and chain it in before lp */
-	(*pp)->l_pos = pos;
-	(*pp)->l_next = lp;
-
-	/* and record the benefit */
+	/* add it, and record the benefit */
+	*wp |= L_BIT( pt );
 	mp->m_libs++;
 	return( 1 );
 }
@@ -122,36 +182,24 @@ int l_gain( struct move *mp, pos_t pos )
  *	to remove a liberty from a string
  *
  * parms:
+ *	game in which the string is found
  *	pointer to move node being deprived of a liberty
- *	position to be removed as a liberty
+ *	point to be removed as a liberty
  *
  * returns:
  *	number of liberties lost (1/0)
  */
-int l_lose( struct move *mp, pos_t pos )
-{	register struct libs *lp, **pp;
-
-	pp = &mp->m_liblist;
-	for( lp = *pp; lp; lp = *pp )
-	{	/* see if we found the liberty we're seeking */
-		if (lp->l_pos.row_col == pos.row_col)
-		{	*pp = lp->l_next;
-			lp->l_next = freelibs;
-			freelibs = lp;
-			mp->m_libs--;
-			return( 1 );
-		}
-
-		/* see if we've passed where it should be */
-		if (lp->l_pos.row_col > pos.row_col)
-			return( 0 );
+int l_lose( struct game_ctx *gp, struct move *mp, int pt )
+{	register lword_t *wp = &L_WORD( mp->m_libset, pt );
 
-		/* continue on down the list */
-		pp = &lp->l_next;
-	}
+	/* see if it really was one of our liberties */
+	if ((*wp & L_BIT( pt )) == 0)
+		return( 0 );
 
-	/* we didn't find it to delete */
-	return( 0 );
+	/* take it away, and record the loss */
+	*wp &= ~L_BIT( pt );
+	mp->m_libs--;
+	return( 1 );
 }
 
 /*
@@ -162,52 +210,30 @@ int l_lose( struct move *mp, pos_t pos )
  *	to union/merge the libertys of two strings
  *
  * parms:
- *	address of liberty list head in the new string
- *	address of liberty list head in the old string
+ *	game in which the strings are found
+ *	address of move node for the new string
+ *	address of move node for the old string
  *
  * returns:
  *	number of liberties in the merged string
  *
  * notes:
- *	for efficiency reason, liberty lists are sorted in order
- *	of increasing positions.  Thus, this is a merge of two
- *	sorted lists.
+ *	the old string's liberty set is left unchanged, since it will
+ *	be needed again if the new string is ever taken back.
  */
-int l_merge( struct move *np, struct move *op )
-{	register struct libs *lp;	/* place to insert before */
-	register struct libs **pp;	/* pointer to insert after */
-	register struct libs *xp;	/* pointer to liberty being merged */
-
-	/* start with insertion pointers at the front of the newstring list */
-	pp = &np->m_liblist; 
-	lp = *pp;
-
-	/* we must merge in each element of the old strings liberty list */
-	for( xp = op->m_liblist; xp; xp = xp->l_next )
-	{	/* skip to the proper insertion point */
-		while( lp != 0  &&  lp->l_pos.row_col < xp->l_pos.row_col)
-		{	pp = &lp->l_next;
-			lp = *pp;
-		}
+int l_merge( struct game_ctx *gp, struct move *np, struct move *op )
+{	register lword_t *sp = np->m_libset;
+	register lword_t *xp = op->m_libset;
+	register lword_t *ep = &sp[ gp->g_libwords ];
+	register int count = 0;
 
-		/* see if this liberty is already present */
-		if (lp->l_pos.row_col == xp->l_pos.row_col)
-			continue;
-
-		/* we found insertion point, so get a free liberty node */
-		if (freelibs == 0)
-			l_ransack( l_quota );
-		*pp = freelibs;
-		freelibs = freelibs->l_next;
-
-		/* label it with the position and chain it in before lp */
-		(*pp)->l_pos.row_col = xp->l_pos.row_col;
-		(*pp)->l_next = lp;
-		pp = &((*pp)->l_next);
-		np->m_libs++;
+	for( ; sp < ep; sp++, xp++ )
+	{	*sp |= *xp;
+		count += L_COUNT( *sp );
 	}
 
-	return( np->m_libs );
+	np->m_libs = count;
+	return( count );
 }
 
 /*
@@ -215,24 +241,47 @@ int l_merge( struct move *np, struct move *op )
  *	l_free
  *
  * purpose:
- *	to free all the liberty nodes associated with a string
+ *	to take away all of the liberties associated with a string
  *
  * parms:
+ *	game in which the string is found
  *	pointer to the move node being deallocated
  *
  * returns:
  *	void for now
+ *
+ * note:
+ *	the set itself stays with the move table entry, for reuse
  */
-void l_free( struct move *mp )
-{	register struct libs *lp, *np;
+void l_free( struct game_ctx *gp, struct move *mp )
+{
+	if (mp->m_libset)
+		l_clear( gp, mp );
+	mp->m_libs = 0;
+}
 
-	for( lp = mp->m_liblist; lp; lp = np )
-	{	np = lp->l_next;
-		lp->l_next = freelibs;
-		freelibs = lp;
-	}
+#ifndef __GNUC__
+/*
+ * routines:
+ *	l_count, l_lowest
+ *
+ * purpose:
+ *	to count the bits in a liberty set word, and find the lowest one,
+ *	for compilers that have no builtins for these operations
+ */
+int l_count( lword_t w )
+{	register int n;
 
-	mp->m_libs = 0;
-	mp->m_liblist = 0;
+	for( n = 0; w; n++ )
+		w &= w - 1;
+	return( n );
 }
 
+int l_lowest( lword_t w )
+{	register int n;
+
+	for( n = 0; (w & 1) == 0; n++ )
+		w >>= 1;
+	return( n );
+}
+#endif
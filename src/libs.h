@@ -8,11 +8,41 @@
  */
 
 /*
- * Each string has its liberties enumerated in an ordered linked list.
- * All addition, removal, and merging of liberties is done as operations
- * on these lists.
+ * Each string has its liberties recorded in a bit set, with one bit for
+ * each point on the board (numbered as described in go.h).  Adding
+ * or removing a liberty is a matter of setting or clearing a single bit,
+ * and merging the liberties of two strings is the OR of their sets.  The
+ * number of liberties (m_libs) is kept along with the set, and after a
+ * merge is recomputed by counting the bits in the merged set.
+ *
+ * The sets are all the same width for a given game (g_libwords words),
+ * and are carved out of an arena belonging to the game context (see
+ * game.h).  The arena is a set of fixed size chunks, which are never
+ * moved once allocated.  Each entry in the move table gets its own set
+ * the first time a move is made there, and keeps it (for reuse by later
+ * moves with the same number) until the game is over, so the liberty
+ * sets of old moves (which are needed to undo them) are never disturbed.
+ * When the last chunk is used up, another is added, so liberties never
+ * run out.  Starting a new game merely rewinds the arena to the start
+ * of its first chunk - the chunks themselves are kept for reuse.
  */
-struct libs
-{	struct libs *l_next;	/* address of next liberty in chain */
-	pos_t l_pos;		/* position of this liberty */
-} libs[MAXLIBS];
+#define L_WORDBITS	64	/* bits in a liberty set word (lword_t) */
+#define L_WORDSHIFT	6	/* log2( L_WORDBITS ) */
+
+/* number of words needed to hold a given number of bits */
+#define L_WORDS(bits)	(((bits) + L_WORDBITS - 1) >> L_WORDSHIFT)
+
+/* word and bit, within a set, for a particular point */
+#define L_WORD(set,pt)	((set)[ (pt) >> L_WORDSHIFT ])
+#define L_BIT(pt)	((lword_t) 1 << ((pt) & (L_WORDBITS-1)))
+
+/* number of bits set in a word, and number of the lowest one */
+#ifdef __GNUC__
+#define L_COUNT(w)	__builtin_popcountll( w )
+#define L_LOWEST(w)	__builtin_ctzll( w )
+#else
+int l_count( lword_t w );
+int l_lowest( lword_t w );
+#define L_COUNT(w)	l_count( w )
+#define L_LOWEST(w)	l_lowest( w )
+#endif
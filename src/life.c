@@ -0,0 +1,511 @@
+/*
+ * module:
+ *	life.c
+ *
+ * purpose:
+ *	to decide the life and death of groups that are shut in: can the
+ *	enemy kill the group, and can its owner make it live?
+ *
+ * note:
+ *	the group is named by one of its stones (the target), and its
+ *	region is found by spreading out from it over vacant points and
+ *	friendly stones, and over any enemy stones shut in with it (strings
+ *	all of whose liberties are in the region).  If the region grows too
+ *	large, the group is not shut in, and nothing is decided.  Only
+ *	moves in the region are tried: the attacker's (he may not pass, and
+ *	loses if he has no move) and the defender's (who may also pass).
+ *	The attacker wins if the target is captured; the defender wins if
+ *	he has two eyes (see v_eyes), or if the attacker runs out of moves
+ *	(so seki counts as life), or if the attacker has not killed within
+ *	V_MAXPLY moves.
+ *
+ *	The search is depth first proof-number search (df-pn), in which
+ *	each position has a proof number (phi: how many positions must
+ *	still be settled to show that the player to move wins there) and a
+ *	disproof number (delta: how many to show that he loses), and the
+ *	most promising line is always followed until its numbers pass the
+ *	thresholds set for it.  The numbers are kept in the transposition
+ *	table (see ttable.h), under a key made from the position, the
+ *	simple ko, the target and the ko rule (below).  Positions in which
+ *	either player has won are given a greater depth than those still
+ *	open, so that they are kept longer.  Ko is settled by searching
+ *	twice: once with the player to move forbidden to take kos (if he
+ *	wins anyway, he wins outright), and once with his opponent
+ *	forbidden (if he loses anyway, he loses outright); otherwise, the
+ *	result hangs on a ko.  Positions reached by different paths are
+ *	taken to be the same, even if the moves left to the attacker are
+ *	not.
+ *
+ *	All of the moves are made in the game with its light engine (see
+ *	engine.h), and taken back again.
+ */
+#include <stdio.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "zobrist.h"
+#include "ttable.h"
+
+#define V_MAXREGION	24	/* most points to play on in a group's region */
+#define V_MAXSTONES	160	/* most points (of any kind) in it */
+#define V_MAXPLY	(2 * V_MAXREGION)	/* longest line read */
+#define V_MAXNODES	20000	/* most positions looked at for each answer */
+#define V_INF		0xffff	/* an infinite proof or disproof number */
+#define V_OPEN		1	/* depth for positions still open */
+#define V_SETTLED	64	/* depth for positions that have been won */
+
+#define V_MIN(a,b)	((a) < (b) ? (a) : (b))
+
+/* a proof and a disproof number, as kept in the value of an entry */
+#define V_VALUE(phi,delta)	((phi) << 16 | (delta))
+#define V_PHI(value)		((unsigned) (value) >> 16)
+#define V_DELTA(value)		((value) & 0xffff)
+
+/* a key for a position in a search for a target (the point keys are
+ * scrambled, so that they cannot be mistaken for stones' keys) */
+#define V_KEY(gp,sp)	(T_KEY( (gp)->g_hash, (gp)->g_nxtcolor ) ^ \
+		(z_keys[(sp)->v_color][(sp)->v_target] << 29 | \
+		z_keys[(sp)->v_color][(sp)->v_target] >> 35) ^ \
+		(z_keys[(sp)->v_nokos][V_KOPOINT( gp )] << 13 | \
+		z_keys[(sp)->v_nokos][V_KOPOINT( gp )] >> 51) ^ \
+		0x9e3779b97f4a7c15ULL)
+
+/* point of the simple ko that may not be retaken (0 - none) */
+#define V_KOPOINT(gp)	P_POINT( MOVE( gp, (gp)->g_movenum - 1 )->m_ko )
+
+/* the state of one search */
+struct solver
+{	struct game_ctx *v_game;	/* game being read */
+	int	v_target;		/* point of one of the group's stones */
+	int	v_color;		/* color of the group */
+	int	v_nokos;		/* color that may not take kos */
+	int	v_nodes;		/* positions looked at so far */
+	int	v_nregion;		/* number of points in the region */
+	short	v_region[ V_MAXREGION ]; /* the region's points */
+};
+
+/*
+ * routine:
+ *	v_region
+ *
+ * purpose:
+ *	to find the region in which a group lives or dies
+ *
+ * parms:
+ *	game in which the group is found
+ *	point of one of its stones
+ *	where to put the points of the region that may be played on
+ *
+ * returns:
+ *	number of points found
+ *	0 - the group is not shut in
+ *
+ * note:
+ *	the vacant points and friendly stones that can be reached from
+ *	the group are found first.  An enemy string next to them is shut
+ *	in if all of its liberties are among them, and its stones are then
+ *	part of the region too.
+ */
+static int v_region( struct game_ctx *gp, int pt, short *region )
+{	register struct string *sp;
+	register int i, q;
+	register lword_t w;
+	struct move *mp;
+	int color = gp->g_str[pt].s_color;
+	int nregion = 0;
+	int nstack, nreached, n, k, head;
+	short reached[ V_MAXSTONES ];
+	char seen[ P_POINTS ];
+
+	for( i = 0; i < P_POINTS; i++ )
+		seen[i] = 0;
+
+	/* spread out over vacant points and friendly stones */
+	seen[pt] = 1;
+	reached[0] = pt;
+	nreached = 1;
+	for( nstack = 0; nstack < nreached; nstack++ )
+	{	pt = reached[ nstack ];
+		if (gp->g_str[pt].s_moveno == 0)
+		{	if (nregion >= V_MAXREGION)
+				return( 0 );
+			region[ nregion++ ] = pt;
+		}
+		for( i = 0; i < 4; i++ )
+		{	q = pt + p_adj[i];
+			sp = &gp->g_str[q];
+			if (seen[q]  ||  sp->s_moveno < 0  ||
+				(sp->s_moveno > 0  &&  sp->s_color != color))
+				continue;
+			if (nreached >= V_MAXSTONES)
+				return( 0 );
+			seen[q] = 1;
+			reached[ nreached++ ] = q;
+		}
+	}
+
+	/* and take in the enemy strings with no liberties outside */
+	for( k = 0; k < nreached; k++ )
+		for( i = 0; i < 4; i++ )
+		{	q = reached[k] + p_adj[i];
+			sp = &gp->g_str[q];
+			if (seen[q]  ||  sp->s_moveno <= 0  ||  sp->s_color == color)
+				continue;
+			mp = MOVE( gp, sp->s_moveno );
+			for( n = 0; n < gp->g_libwords; n++ )
+				for( w = mp->m_libset[n]; w; w &= w - 1 )
+					if (!seen[ (n << L_WORDSHIFT) + L_LOWEST( w ) ])
+						goto outside;
+
+			head = q;
+			do
+			{	if (nregion >= V_MAXREGION)
+					return( 0 );
+				seen[q] = 1;
+				region[ nregion++ ] = q;
+				q = gp->g_str[q].s_next;
+			} while( q != head );
+		outside:
+			seen[q] = 1;
+		}
+
+	return( nregion );
+}
+
+/*
+ * routine:
+ *	v_eyes
+ *
+ * purpose:
+ *	to count the eyes of a string
+ *
+ * parms:
+ *	game in which the string is found
+ *	point of one of its stones
+ *
+ * returns:
+ *	number of its liberties that are eyes (see p_eye), and that cannot
+ *	be filled by capturing the stones around them
+ */
+int v_eyes( struct game_ctx *gp, int pt )
+{	register struct move *mp;
+	register lword_t w;
+	register int i, n;
+	int color, eyes;
+
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( 0 );
+	color = gp->g_str[pt].s_color;
+	mp = MOVE( gp, gp->g_str[pt].s_moveno );
+
+	eyes = 0;
+	for( n = 0; n < gp->g_libwords; n++ )
+		for( w = mp->m_libset[n]; w; w &= w - 1 )
+		{	pt = (n << L_WORDSHIFT) + L_LOWEST( w );
+			if (!p_eye( gp, pt, color ))
+				continue;
+			for( i = 0; i < 4; i++ )
+				if (gp->g_str[ pt + p_adj[i] ].s_moveno > 0  &&
+					MOVE( gp, gp->g_str[ pt + p_adj[i] ].s_moveno )->m_libs < 2)
+					break;
+			if (i == 4)
+				eyes++;
+		}
+
+	return( eyes );
+}
+
+/*
+ * routine:
+ *	v_over
+ *
+ * purpose:
+ *	to see whether the fight for a group is over
+ *
+ * parms:
+ *	search being made
+ *	number of moves made in it so far
+ *
+ * returns:
+ *	color of the winner
+ *	-1 - the fight goes on
+ */
+static int v_over( struct solver *sp, int ply )
+{	register struct game_ctx *gp = sp->v_game;
+	register struct string *tp = &gp->g_str[ sp->v_target ];
+
+	if (tp->s_moveno <= 0  ||  tp->s_color != sp->v_color)
+		return( !sp->v_color );
+	if (ply >= V_MAXPLY  ||  v_eyes( gp, sp->v_target ) >= 2)
+		return( sp->v_color );
+	return( -1 );
+}
+
+/*
+ * routine:
+ *	v_look
+ *
+ * purpose:
+ *	to find what is known about the position reached in a search
+ *
+ * parms:
+ *	search being made
+ *	number of moves made in it so far
+ *	where to put the proof number for the player to move
+ *	where to put his disproof number
+ */
+static void v_look( struct solver *sp, int ply, int *phip, int *deltap )
+{	register struct game_ctx *gp = sp->v_game;
+	int winner;
+	hash_t data;
+
+	if ((winner = v_over( sp, ply )) >= 0)
+	{	*phip = (winner == gp->g_nxtcolor) ? 0 : V_INF;
+		*deltap = (winner == gp->g_nxtcolor) ? V_INF : 0;
+	} else if (t_probe( V_KEY( gp, sp ), &data ))
+	{	*phip = V_PHI( T_VALUE( data ) );
+		*deltap = V_DELTA( T_VALUE( data ) );
+	} else
+		*phip = *deltap = 1;
+}
+
+/*
+ * routine:
+ *	v_try
+ *
+ * purpose:
+ *	to see whether a move may be tried in a search, and what is known
+ *	about the position it leads to
+ *
+ * parms:
+ *	search being made
+ *	point of the move (0 - pass)
+ *	number of moves made in the search after it
+ *	where to put the proof number for the player to move after it
+ *	where to put his disproof number
+ *
+ * returns:
+ *	TRUE	the move may be tried
+ *	FALSE	it is illegal, or takes a ko that the player may not take
+ */
+static int v_try( struct solver *sp, int pt, int ply, int *phip, int *deltap )
+{	register struct game_ctx *gp = sp->v_game;
+	int first = gp->g_movenum;
+	int color = gp->g_nxtcolor;
+
+	if (!p_make( gp, pt ))
+		return( FALSE );
+	if (color == sp->v_nokos  &&  MOVE( gp, first )->m_ko.row_col)
+	{	p_back( gp, first );
+		return( FALSE );
+	}
+
+	v_look( sp, ply, phip, deltap );
+	p_back( gp, first );
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	v_mid
+ *
+ * purpose:
+ *	to search a position until its proof or disproof number reaches
+ *	the threshold set for it
+ *
+ * parms:
+ *	search being made
+ *	number of moves made in it so far
+ *	threshold for the proof number of the player to move
+ *	threshold for his disproof number
+ *	where to put the proof number found
+ *	where to put the disproof number found
+ *
+ * returns:
+ *	the move with the best proof number (-1 - there are none)
+ *
+ * note:
+ *	the player to move wins if any of his moves leads to a position
+ *	that his opponent loses, and loses if all of them lead to positions
+ *	that his opponent wins, so his proof number is the least of the
+ *	disproof numbers after his moves, and his disproof number is the
+ *	sum of the proof numbers after them.  The move to be searched is
+ *	the one with the least disproof number after it, until it is no
+ *	longer (by one) better than the next best, or its numbers take the
+ *	position's past one of the thresholds.
+ */
+static int v_mid( struct solver *sp, int ply, int thphi, int thdelta, int *phip, int *deltap )
+{	register struct game_ctx *gp = sp->v_game;
+	register int k, q;
+	int first = gp->g_movenum;
+	int attacker = gp->g_nxtcolor != sp->v_color;
+	int phi, delta, second, best, nkids;
+	int kids[ V_MAXREGION + 1 ];
+	int kphi[ V_MAXREGION + 1 ];
+	int kdelta[ V_MAXREGION + 1 ];
+
+	sp->v_nodes++;
+	if (v_over( sp, ply ) >= 0)
+	{	v_look( sp, ply, phip, deltap );
+		return( -1 );
+	}
+
+	/* list the moves (the defender needn't fill his own eyes) */
+	nkids = 0;
+	for( k = 0; k < sp->v_nregion; k++ )
+	{	q = sp->v_region[k];
+		if (gp->g_str[q].s_moveno != 0)
+			continue;
+		if (!attacker  &&  p_eye( gp, q, sp->v_color ))
+			continue;
+		if (v_try( sp, q, ply + 1, &kphi[nkids], &kdelta[nkids] ))
+			kids[ nkids++ ] = q;
+	}
+	if (!attacker  &&  v_try( sp, 0, ply + 1, &kphi[nkids], &kdelta[nkids] ))
+		kids[ nkids++ ] = 0;
+
+	for( ;; )
+	{	phi = second = V_INF;
+		delta = 0;
+		best = -1;
+		for( k = 0; k < nkids; k++ )
+		{	if (kdelta[k] < phi)
+			{	second = phi;
+				phi = kdelta[k];
+				best = k;
+			} else if (kdelta[k] < second)
+				second = kdelta[k];
+			if (kphi[k] >= V_INF  ||  delta + kphi[k] >= V_INF)
+				delta = (kphi[k] >= V_INF) ? V_INF : V_INF - 1;
+			else
+				delta += kphi[k];
+		}
+
+		if (phi >= thphi  ||  delta >= thdelta  ||  sp->v_nodes >= V_MAXNODES)
+			break;
+
+		/* search the best move, until it is no longer the best */
+		if (!p_make( gp, kids[best] ))
+			break;
+		(void) v_mid( sp, ply + 1,
+			V_MIN( thdelta - delta + kphi[best], V_INF ),
+			V_MIN( thphi, second + 1 ), &kphi[best], &kdelta[best] );
+		p_back( gp, first );
+	}
+
+	t_store( V_KEY( gp, sp ), (phi == 0  ||  delta == 0) ? V_SETTLED : V_OPEN,
+		0, V_VALUE( phi, delta ) );
+	*phip = phi;
+	*deltap = delta;
+	return( best < 0 ? -1 : kids[best] );
+}
+
+/*
+ * routine:
+ *	v_solve
+ *
+ * purpose:
+ *	to see whether the player to move wins the fight for a group
+ *
+ * parms:
+ *	game in which the group is found
+ *	point of one of its stones
+ *	its region (see v_region)
+ *	number of points in the region
+ *	color that may not take kos
+ *	where to put the winning move (0 - pass)
+ *
+ * returns:
+ *	TRUE	the player to move wins
+ *	FALSE	he loses
+ *	-1	the search gave out before it was decided
+ */
+static int v_solve( struct game_ctx *gp, int pt, short *region, int nregion,
+	int nokos, int *movep )
+{	struct solver sv;
+	int phi, delta, move, i;
+
+	sv.v_game = gp;
+	sv.v_target = pt;
+	sv.v_color = gp->g_str[pt].s_color;
+	sv.v_nokos = nokos;
+	sv.v_nodes = 0;
+	sv.v_nregion = nregion;
+	for( i = 0; i < nregion; i++ )
+		sv.v_region[i] = region[i];
+
+	move = v_mid( &sv, 0, V_INF, V_INF, &phi, &delta );
+	*movep = (phi == 0  &&  move > 0) ? move : 0;
+	if (phi == 0)
+		return( TRUE );
+	if (delta == 0)
+		return( FALSE );
+	return( -1 );
+}
+
+/*
+ * routine:
+ *	v_status
+ *
+ * purpose:
+ *	to decide the life and death of a group that is shut in
+ *
+ * parms:
+ *	game in which the group is found
+ *	point of one of its stones
+ *	color of the player to move first
+ *	where to put his best move (0 - none is needed, or none will do)
+ *
+ * returns:
+ *	V_ALIVE		the group lives (whatever the attacker does)
+ *	V_DEAD		the group dies (whatever the defender does)
+ *	V_KO		the group lives or dies with a ko
+ *	V_UNKNOWN	it is not shut in, or it is too hard to read
+ *
+ * note:
+ *	the game is left as it was found.  The caller must see that the
+ *	transposition table has been allocated (see t_init) if the search
+ *	is to get anywhere.
+ */
+int v_status( struct game_ctx *gp, int pt, int color, int *movep )
+{	struct engine *ep = gp->g_engine;
+	short region[ V_MAXREGION ];
+	int first = gp->g_movenum;
+	int nregion, defender, strict, loose, move;
+	int result = V_UNKNOWN;
+
+	*movep = 0;
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( V_UNKNOWN );
+	defender = gp->g_str[pt].s_color;
+	if (U_SAFE( gp, pt, defender ))
+		return( V_ALIVE );
+	if (U_SAFE( gp, pt, !defender ))
+		return( V_DEAD );
+	if ((nregion = v_region( gp, pt, region )) == 0)
+		return( V_UNKNOWN );
+
+	gp->g_engine = ep->e_light;
+	if (gp->g_nxtcolor == color  ||  p_make( gp, 0 ))
+	{	/* can he win even if he may take no kos, or only if he may? */
+		strict = v_solve( gp, pt, region, nregion, color, movep );
+		if (strict == TRUE)
+			result = (color == defender) ? V_ALIVE : V_DEAD;
+		else
+		{	loose = v_solve( gp, pt, region, nregion, !color, &move );
+			if (loose == FALSE)
+				result = (color == defender) ? V_DEAD : V_ALIVE;
+			else if (loose == TRUE  &&  strict == FALSE)
+			{	result = V_KO;
+				*movep = move;
+			}
+		}
+		p_back( gp, first );
+	}
+	gp->g_engine = ep;
+
+	return( result );
+}
@@ -12,6 +12,12 @@
 #include <string.h>
 #include "go.h"
 #include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "pattern.h"
+#include "joseki.h"
+#include "book.h"
 
 int	doneflg;		/* we are done processing */
 int	errcode;		/* return code */
@@ -36,9 +42,10 @@ void machmain( int argc, char **argv );
  *	or <number><letter>.  All other commands start with a letter.
  *	For convenience, we allow a slightly context sensitive input
  *	format.  If a command is a letter followed immediately by a 
- *	number, we treat it as a move.  If the letter is followed by
- *	a non-number (such as a blank or another letter) we treat it
- *	as a non-move command.  This creates a marginally ambiguous input
+ *	number, we treat it as a move (upper case letters name the
+ *	columns beyond z on very large boards).  If the letter is
+ *	followed by a non-number (such as a blank or another letter)
+ *	we treat it as a non-move command.  This creates a marginally ambiguous input
  *	format, where "h4" is a move but "h 4" is a request for four
  *	handicap stones.  The ambiguity is regrettable, but it probably
  *	lets people do what they want more easily than some other 
@@ -57,8 +64,8 @@ void docmd( char *cmd )
 		cmd++;
 
 	/* check for an semi-ambiguous move specification */
-	if (*cmd >= 'a' && *cmd <= 's' && cmd[1] >= '0' && cmd[1] <= '9')
-	{	c_move( nxt_color, cmd, 0 );
+	if (COLNUM( *cmd ) && cmd[1] >= '0' && cmd[1] <= '9')
+	{	c_move( cur_game->g_nxtcolor, cmd, 0 );
 		return;
 	}
 
@@ -95,13 +102,14 @@ void docmd( char *cmd )
 		else
 			number = boardsize;
 
-		if (movenum == 1  || confirm("Start a new %d line game? (y)", 
+		if (cur_game->g_movenum == 1  || 
+		    confirm("Start a new %d line game? (y)", 
 						number))
 			c_newgame( number );
 		break;
 
 	  case 'q': /* quit immedately */
-		if (movenum == 1  || confirm("Quit without saving? (y)"))
+		if (cur_game->g_movenum == 1 || confirm("Quit without saving? (y)"))
 			doneflg++;
 		break;
 
@@ -131,11 +139,11 @@ void docmd( char *cmd )
 	   */
 	  case '0': case '1': case '2': case '3': case '4': 
 	  case '5': case '6': case '7': case '8': case '9': 
-		c_move( nxt_color, cmd, 0 );
+		c_move( cur_game->g_nxtcolor, cmd, 0 );
 		break;
 
 	  case '-': /* pass */
-		c_move( nxt_color, "-", 0 );
+		c_move( cur_game->g_nxtcolor, "-", 0 );
 		break;
 
 	  case 'a': /* specify player ability */
@@ -183,6 +191,10 @@ void docmd( char *cmd )
 		c_move( WHITE, arg, 0 );
 		break;
 
+	  case 'c': /* computer move */
+		c_search( arg );
+		break;
+
 	  case 'u': /* unmove */
 		if (arg && *arg > '0' && *arg <= '9')
 			c_unmove( atoi( arg ) );
@@ -194,6 +206,18 @@ void docmd( char *cmd )
 		c_replay( arg );
 		break;
 
+	  case 'l': /* learn patterns */
+		c_patterns( arg );
+		break;
+
+	  case 'j': /* joseki */
+		c_joseki( arg );
+		break;
+
+	  case 'k': /* opening book */
+		c_book( arg );
+		break;
+
 	  /*
 	   * miscelaneous commands
 	   */
@@ -220,6 +244,12 @@ void docmd( char *cmd )
 		     case 'e':
 			file_echo = 1;
 			break;
+		     case 't':	/* transposition table size (megabytes) */
+			s_ponder( cur_game, FALSE );
+			t_resize( atoi( arg ) );
+			while( *arg >= '0' && *arg <= '9' )
+				arg++;
+			break;
 		    }
 
 		if (!darkness)
@@ -256,7 +286,7 @@ void docmd( char *cmd )
 
 	  case '?':
 		help( arg );
-		b_redraw( TRUE );
+		b_redraw( cur_game, TRUE );
 		break;
 	}
 }
@@ -311,7 +341,7 @@ void cmdloop( char *cmdfile )
 
 			/* update the screen */
 			darkness = save;
-			b_redraw( TRUE );
+			b_redraw( cur_game, TRUE );
 
 			/* close the command file */
 			(void) fclose( infile ); 
@@ -378,8 +408,17 @@ int main( int argc, char **argv )
 	/* initialize the display and screen */
 	d_init();
 
+	/* read the pattern database, if there is one */
+	(void) q_load( Q_DEFFILE, FALSE );
+
+	/* and map the joseki dictionary, if there is one */
+	(void) j_open( J_DEFFILE, FALSE );
+
+	/* and the opening book */
+	(void) b_open( B_DEFFILE, FALSE );
+
 	/* start a new game on a standard board */
-	c_newgame( MAXBOARD );
+	c_newgame( DEFBOARD );
 
 	/* if user is a regular, run his initialization file */
 	if (initfile)
@@ -407,13 +446,14 @@ int main( int argc, char **argv )
 
 	/* re-enable screen updates, and put up a reasonable one */
 	darkness = FALSE;
-	b_redraw( TRUE );
+	b_redraw( cur_game, TRUE );
 
 	/* and go on to process terminal input */
 	if (!doneflg &&  !errcode)
 		cmdloop( (char *) NULL );
 
 	/* cleanup and return */
+	s_ponder( cur_game, FALSE );
 	d_cleanup();
 	exit( errcode );
 }
@@ -6,11 +6,16 @@
  *	basic movement commands and utilities
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "go.h"
 #include "disp.h"
 #include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
 
 /*
  * routine:
@@ -29,13 +34,18 @@ void c_newgame( int bsize )
 	(void) strcpy( gamename, nicedate( time((time_t *) 0) ) );
 	d_header( "" );
 
-	b_boardsize( bsize ); /* create board of the appropriate size */
+	/* the console game is the one that gets displayed */
+	if (cur_game == 0)
+	{	cur_game = g_new( bsize );
+		if (cur_game == 0)
+			return;
+		cur_game->g_fantasy = FALSE;
+	}
 
-	h_reset();	/* clear out the move history */
-	b_reset();	/* reset the display board */
-	m_reset();	/* reset the mechanical boards */
-	l_reset();	/* reset the liberty lists */
-	i_reset();	/* reset the influence board */
+	b_boardsize( cur_game, bsize ); /* create board of appropriate size */
+	g_reset( cur_game );		/* reset everything else to scratch */
+	spotpoints = 0;
+	s_follow( cur_game );		/* the search tree may still do */
 }
 
 /*
@@ -44,20 +54,101 @@ void c_newgame( int bsize )
  *
  * purpose:
  *	to reset the move history for a new game
+ *
+ * parms:
+ *	game whose history is to be reset
  */
-void h_reset()
-{	register struct move *mp;
-	register int *ip;
-
-	/* zero out the move history */
-	mp = &moves[MAXMOVE];	/* stop at end of the move table */
-	ip = (int *) moves;	/* start of the move table */
-	while( ip < (int *) mp )
-		*ip++ = 0;
-
-	movenum = 1;
-	nxt_color = BLACK;
-	spotpoints = 0;
+void h_reset( struct game_ctx *gp )
+{
+	/* forget the old history, keeping its chunks for reuse */
+	gp->g_movehigh = 0;
+	gp->g_movenum = 0;
+
+	/* move zero is the (empty) predecessor of the first real move */
+	if (h_newmove( gp ) == 0)
+	{	d_msg( "*** Unable to allocate a move table" );
+		d_cleanup();
+		exit( -1 );
+	}
+
+	gp->g_movenum = 1;
+	gp->g_nxtcolor = BLACK;
+}
+
+/*
+ * routine:
+ *	h_newmove
+ *
+ * purpose:
+ *	to find the move table entry for the move about to be made
+ *
+ * parms:
+ *	game in which the move is to be made
+ *
+ * returns:
+ *	pointer to the entry for move g_movenum
+ *	0 - the game is too long, or no memory for another chunk
+ *
+ * note:
+ *	an entry is cleared the first time a game reaches it, and is left
+ *	alone (with its liberty set) if it is used again after an undo.
+ *	Chunks are allocated as needed, and kept until the game is freed.
+ */
+struct move *h_newmove( struct game_ctx *gp )
+{	register struct move **cp;
+	register struct move *mp;
+	register int n = gp->g_movenum;
+	register char *p;
+
+	if (n > MAXMOVE)
+		return( 0 );
+
+	if (n >= gp->g_movehigh)
+	{	/* we may need another chunk, and a bigger directory */
+		if ((n >> M_CHUNKSHIFT) >= gp->g_nmchunks)
+		{	cp = (struct move **) realloc( (char *) gp->g_movechunk,
+				(gp->g_nmchunks + 1) * sizeof (struct move *) );
+			if (cp == 0)
+				return( 0 );
+			gp->g_movechunk = cp;
+			mp = (struct move *) malloc( MOVECHUNK * sizeof (struct move) );
+			if (mp == 0)
+				return( 0 );
+			cp[ gp->g_nmchunks++ ] = mp;
+		}
+
+		/* clear this entry out before its first use in this game */
+		mp = MOVE( gp, n );
+		for( p = (char *) mp; p < (char *) &mp[1]; p++ )
+			*p = 0;
+		mp->m_num = n;
+		gp->g_movehigh = n + 1;
+	}
+
+	return( MOVE( gp, n ) );
+}
+
+/*
+ * routine:
+ *	h_release
+ *
+ * purpose:
+ *	to give back all of the memory in a game's move table
+ *
+ * parms:
+ *	game whose move table is to be released
+ */
+void h_release( struct game_ctx *gp )
+{	register int i;
+
+	for( i = 0; i < gp->g_nmchunks; i++ )
+		free( (char *) gp->g_movechunk[i] );
+	if (gp->g_movechunk)
+		free( (char *) gp->g_movechunk );
+
+	gp->g_movechunk = 0;
+	gp->g_nmchunks = 0;
+	gp->g_movehigh = 0;
 }
 
 /*
@@ -73,7 +164,14 @@ void h_reset()
  *	flags to be set in move
  */
 void c_move( int color, char *position, int flags )
-{	register struct move *mp = &moves[ movenum ];
+{	register struct game_ctx *gp = cur_game;
+	register struct move *mp;
+
+	/* find a place to record the move */
+	if ((mp = h_newmove( gp )) == 0)
+	{	d_msg( "Unable to record move %d", gp->g_movenum );
+		return;
+	}
 
 	/* note whose move this is going to be */
 	mp->m_flags = color * M_COLOR;
@@ -81,8 +179,11 @@ void c_move( int color, char *position, int flags )
 	if (position == 0  ||  *position == '-')
 	{	/* pass moves are particularly easy to handle */
 		mp->m_pos.row_col = 0;
+		mp->m_point = 0;
 		mp->m_stones = 0;
 		mp->m_libs = 0;
+		mp->m_kills = 0;
+		mp->m_ataris = 0;
 		mp->m_ko.row_col = 0;
 	} else	
 	{	/* make sure the move is syntactically valid and non-absurd */
@@ -91,7 +192,7 @@ void c_move( int color, char *position, int flags )
 			return;
 
 		/* do a quick tactical analysis of the move */
-		if (!m_move( mp ))
+		if (!m_move( gp, mp ))
 			return;
 
 		/* make special note of handicap moves */
@@ -102,12 +203,18 @@ void c_move( int color, char *position, int flags )
 	} 
 
 	/* update the move log */
-	m_logmove( (FILE *) NULL, movenum );
+	m_logmove( gp, (FILE *) NULL, gp->g_movenum );
 	d_update();
 
 	/* figure out whose move it is next */
-	nxt_color = (color == WHITE) ? BLACK : WHITE;
-	movenum++;
+	gp->g_nxtcolor = (color == WHITE) ? BLACK : WHITE;
+	gp->g_movenum++;
+
+	/* see what is now safe for good */
+	u_update( gp );
+
+	/* and keep the search tree with the game */
+	s_follow( gp );
 }
 
 /*
@@ -123,6 +230,7 @@ void c_move( int color, char *position, int flags )
 void c_unmove( int nmove )
 {	register int i = nmove;
 	register struct move *mp;
+	register struct game_ctx *gp = cur_game;
 	int save;
 
 	/* suppress screen updates if we are going to undo alot */
@@ -132,20 +240,15 @@ void c_unmove( int nmove )
 	}
 
 	/* back out the specified number of moves */
-	while( i--  &&  movenum > 1 )
-	{	/* make sure this move is reversible */
-		if (movenum <= pillage + 1)
-		{	d_msg( "Impossible to undo beyond move %d", movenum-1 );
-			break;
-		}
-
-		/* back up our idea of whose turn it is */
-		mp = &moves[ --movenum ];
-		nxt_color = mp->m_flags & M_COLOR;
+	while( i--  &&  gp->g_movenum > 1 )
+	{	/* back up our idea of whose turn it is */
+		--gp->g_movenum;
+		mp = MOVE( gp, gp->g_movenum );
+		gp->g_nxtcolor = mp->m_flags & M_COLOR;
 
 		/* undo the tactical implications of the move */
 		if (mp->m_pos.row_col)
-			m_unmove( mp );
+			m_unmove( gp, mp );
 
 		/* void the move in the internal move record */
 		mp->m_pos.row_col = 0;
@@ -153,14 +256,20 @@ void c_unmove( int nmove )
 
 		/* take the move out of the displayed game history */
 		if (!darkness)
-			d_showmove( movenum, "...         " );
+			d_showmove( gp->g_movenum, "...         " );
 	}
 
 	/* and update the screen (if we suppressed updates) */
 	if (nmove > 2)
 	{	darkness = save;
-		b_redraw( TRUE );
+		b_redraw( gp, TRUE );
 	}
+
+	/* what was safe may not be any more */
+	u_update( gp );
+
+	/* the search tree may still know this position */
+	s_follow( gp );
 }
 
 /*
@@ -171,17 +280,18 @@ void c_unmove( int nmove )
  *	to log a move, either to a game record or to the screen
  *
  * parameters:
+ *	game in which the move was made
  *	FILE for log file (NULL -> screen)
  *	move number to be logged
  */
-void m_logmove( FILE *file, int num )
+void m_logmove( struct game_ctx *gp, FILE *file, int num )
 {	char row, col, color;
 	register struct move *mp;
 	char buf[32];
 
-	mp = &moves[ num ];
+	mp = MOVE( gp, num );
 	row = mp->m_pos.sub.row;
-	col = 'a' + mp->m_pos.sub.col - 1;
+	col = COLNAME( mp->m_pos.sub.col );
 	if (mp->m_flags & M_HANDICAP)
 		color = 'B';
 	else
@@ -231,7 +341,7 @@ void c_handicap( int num )
 {	register int i, row, col;
 	char hmoves[MAXHAND][4];	/* buffer for handicap moves */
 
-	if (movenum > 1)
+	if (cur_game->g_movenum > 1)
 	{	d_msg( "handicaps only possible at start of game" );
 		return;
 	}
@@ -246,7 +356,7 @@ void c_handicap( int num )
 	for( row = 1; row <= boardsize; row++ )
 		for( col = 1; col <= boardsize; col++ )
 			if (i = hnd_board[row][col])
-			{	hmoves[i][0] = 'a' + col - 1;
+			{	hmoves[i][0] = COLNAME( col );
 				hmoves[i][1] = '0' + (row/10);
 				hmoves[i][2] = '0' + (row%10);
 				hmoves[i][3] = 0;
@@ -307,9 +417,10 @@ int chkmove( char *arg )
 	pos_t pos;
 
 	/* figure out whether the postion is row-first or col-first */
-	if (*arg >= 'a' && *arg <= 's')
+	if (COLNUM( *arg ))
 	{	/* column first */
-		col = 1 + *arg++ - 'a';
+		col = COLNUM( *arg );
+		arg++;
 
 		while( *arg >= '0' && *arg <= '9' )
 		{	row *= 10;
@@ -324,8 +435,7 @@ int chkmove( char *arg )
 			arg++;
 		}
 
-		if (*arg >= 'a' && *arg < 'z')
-			col = 1 + *arg - 'a';
+		col = COLNUM( *arg );
 	}
 
 	/* check them for reasonableness */
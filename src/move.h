@@ -15,7 +15,18 @@
  * stones are killed, the group definitions are left intact, but hung
  * under the group definition for the stone that killed them.  Undoing
  * a move can be acomplished by restoring the trees that have been
- * hung under that move.  These trees are maintained by tactics.c
+ * hung under that move.  These trees are maintained by mechanix.c.
+ * (The stones of each string are also linked into a ring on the string
+ * board, see strings.h, which is what we walk to visit them.)
+ *
+ * The move table is kept in chunks of MOVECHUNK moves, which are added
+ * as the game grows and never moved, so a pointer to a move stays good
+ * for the life of the game.  Because consecutive moves may lie in
+ * different chunks, move n must always be found with MOVE(gp,n) - never
+ * by pointer arithmetic on some other move.  Each move knows its own
+ * number (m_num).  Entries are only cleared when a game first reaches
+ * them (see h_newmove), so starting a new game costs nothing, and the
+ * chunks (with the liberty sets hung from their moves) are reused.
  *
  * note that these structures are used in a three step process
  *	someone wants to make a move, and fills in color and position
@@ -30,35 +41,58 @@
  *	whether the hostile neighbor was killed or merely impinged upon.
  */
 struct move
-{	struct libs *m_liblist;	/* pointer to list of liberties	*/
+{	lword_t	*m_libset;	/* pointer to set of liberties	*/
+	short	m_num;		/* number of this move		*/
 	short	m_neighbor[4];	/* links to affected neighbors	*/
 	short   m_netlib;	/* net liberties gained by move */
 	pos_t	m_pos;		/* position of this move	*/
+	short	m_point;	/* point number of m_pos	*/
 	pos_t	m_ko;		/* position of created KO	*/
+	short	m_oldnext;	/* ring link found under stone	*/
+	short	m_oldstone;	/* stone number found under it	*/
+	short	m_stones;	/* # of stones in new group	*/
+	short	m_libs;		/* # of liberties to this group	*/
+	short	m_kills;	/* # of hostile stones killed	*/
+	short	m_ataris;	/* # of hostile stones atari'd	*/
 	unsigned char m_flags;	/* flags to describe this move	*/
-	unsigned char m_stones;	/* # of stones in new group	*/
-	unsigned char m_libs;	/* # of liberties to this group	*/
 	unsigned char m_eyes;	/* # of eyes to this group	*/
-	unsigned char m_kills;	/* # of hostile stones killed	*/
-	unsigned char m_ataris;	/* # of hostile stones atari'd	*/
 	unsigned char m_gkills;	/* # of hostile groups killed	*/
 	unsigned char m_hurts;	/* # of hostile liberties lost	*/
-} moves[ MAXMOVE ];
+};
+
+/* the move table is a directory of chunks of moves */
+#define M_CHUNKSHIFT	8	/* log2( MOVECHUNK ) */
+#define MOVECHUNK	(1 << M_CHUNKSHIFT)	/* moves per chunk */
+#define MOVE(gp,n)	(&(gp)->g_movechunk[ (n) >> M_CHUNKSHIFT ][ (n) & (MOVECHUNK-1) ])
 
 /* bits in the m_flags field */
 #define M_COLOR		0x01	/* is this move black or white	*/
 #define M_HANDICAP	0x02	/* is this move a handicap	*/
 #define M_MULTIPLE	0x04	/* does it make multiple atari	*/
 #define M_BLUNDER	0x08	/* was this move a foolish one	*/
+#define M_PATTERN	0x10	/* did it keep the pattern hashes */
+
+/*
+ * a game record, as read from a saved game (see a_record).  Only the
+ * board size and the moves are kept; each move is a point number (0
+ * for a pass) and the color that made it.  Very long games are cut off
+ * after MAXRECORD moves.
+ */
+#define MAXRECORD	1024	/* most moves kept from a record */
+
+struct record
+{	int	r_size;			/* number of lines on the board */
+	int	r_nmoves;		/* number of moves */
+	short	r_point[ MAXRECORD ];	/* point of each move (0 - pass) */
+	char	r_color[ MAXRECORD ];	/* color that made it */
+};
 
 /* move related functions */
-void m_reset();
-int m_move( struct move *mp );
-void m_estimate( struct move *mp );
-void m_do( struct move *mp );
-void m_unmove( struct move *mp );
-void m_restore( struct move *mp, int value, int killer );
-void l_free( struct move *mp );
-int l_merge( struct move *np, struct move *op );
-int l_lose( struct move *mp, pos_t pos );
-int l_gain( struct move *mp, pos_t pos );
+struct move *h_newmove( struct game_ctx *gp );
+void m_reset( struct game_ctx *gp );
+int m_move( struct game_ctx *gp, struct move *mp );
+void l_clear( struct game_ctx *gp, struct move *mp );
+void l_free( struct game_ctx *gp, struct move *mp );
+int l_merge( struct game_ctx *gp, struct move *np, struct move *op );
+int l_lose( struct game_ctx *gp, struct move *mp, int pt );
+int l_gain( struct game_ctx *gp, struct move *mp, int pt );
@@ -0,0 +1,720 @@
+/*
+ * module:
+ *	pattern.c
+ *
+ * purpose:
+ *	to keep the hashes of the large patterns around each point, and to
+ *	rate moves by how often they were played in the games learned from
+ *
+ * note:
+ *	see pattern.h for how the patterns are hashed, and how the hashes
+ *	are kept up to date.  The database is shared by all of the games
+ *	(and threads); it is only changed by console commands, which must
+ *	first stop any pondering.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "go.h"
+#include "disp.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "pattern.h"
+
+#define Q_SEED	0x2545f4914f6cdd1dULL	/* arbitrary, but fixed, seed */
+
+/* the points of the largest diamond, nearest first */
+static int q_dr[ Q_OFFSETS ];		/* rows from the center */
+static int q_dc[ Q_OFFSETS ];		/* columns from the center */
+static int q_dist[ Q_OFFSETS ];		/* distance from the center */
+static int q_sym[ Q_SYMS ][ Q_OFFSETS ]; /* where each symmetry takes them */
+
+/* keys for what is found at each point, and for each radius */
+static hash_t q_keys[3][ Q_OFFSETS ];
+static hash_t q_rkeys[ Q_MAXDIST ];
+
+/* what a stone of each color at each point does to the rings of the
+ * center, for each player to move and each symmetry */
+static hash_t q_delta[2][ Q_OFFSETS ][2][ Q_SYMS ];
+
+/* the database of patterns */
+static struct qentry *q_table;	/* open hash table of patterns */
+static int q_mask;		/* size of that table, less one */
+static int q_count;		/* number of patterns in that table */
+
+/*
+ * routine:
+ *	q_init
+ *
+ * purpose:
+ *	to build the tables of points and keys that patterns are made from
+ *
+ * note:
+ *	the keys come from a splitmix64 generator (as in zobrist.c), with
+ *	a seed of their own.  They must be the same in every run, or the
+ *	database would mean nothing.  Symmetry s mirrors the rows if its
+ *	1 bit is set, the columns if its 2 bit is, and then exchanges rows
+ *	and columns if its 4 bit is.
+ */
+void q_init()
+{	static int done;
+	register int o, s, i;
+	int n, d, dr, dc, t, color, mover;
+	hash_t x, z;
+	hash_t *kp, *ep;
+
+	if (done)
+		return;
+
+	/* list the points of the diamond, ring by ring */
+	n = 0;
+	for( d = 1; d <= Q_MAXDIST; d++ )
+		for( dr = -d; dr <= d; dr++ )
+			for( dc = -d; dc <= d; dc++ )
+				if ((dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc) == d)
+				{	q_dr[n] = dr;
+					q_dc[n] = dc;
+					q_dist[n++] = d;
+				}
+
+	/* find where each symmetry takes each of them */
+	for( s = 0; s < Q_SYMS; s++ )
+		for( o = 0; o < Q_OFFSETS; o++ )
+		{	dr = (s & 1) ? -q_dr[o] : q_dr[o];
+			dc = (s & 2) ? -q_dc[o] : q_dc[o];
+			if (s & 4)
+			{	t = dr;
+				dr = dc;
+				dc = t;
+			}
+			for( i = 0; q_dr[i] != dr  ||  q_dc[i] != dc; i++ )
+				;
+			q_sym[s][o] = i;
+		}
+
+	/* make up the keys */
+	x = Q_SEED;
+	kp = &q_keys[0][0];
+	ep = kp + (sizeof q_keys / sizeof *kp);
+	for( i = 0; kp < ep  ||  i < Q_MAXDIST; )
+	{	x += 0x9e3779b97f4a7c15ULL;
+		z = x;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		if (kp < ep)
+			*kp++ = z ^ (z >> 31);
+		else
+			q_rkeys[ i++ ] = z ^ (z >> 31);
+	}
+
+	/* and work out what each stone does to the rings that see it */
+	for( color = BLACK; color <= WHITE; color++ )
+		for( o = 0; o < Q_OFFSETS; o++ )
+			for( mover = BLACK; mover <= WHITE; mover++ )
+				for( s = 0; s < Q_SYMS; s++ )
+					q_delta[color][o][mover][s] = q_keys[
+						color == mover ? Q_OWN : Q_ENEMY ][ q_sym[s][o] ];
+
+	done = TRUE;
+}
+
+/*
+ * routine:
+ *	q_xor
+ *
+ * purpose:
+ *	to put a stone into (or take it out of) the rings that see it
+ *
+ * parms:
+ *	game in which the stone is found
+ *	rings to be changed
+ *	point of the stone
+ *	color of the stone
+ */
+static void q_xor( struct game_ctx *gp, struct qpoint *qp, int pt, int color )
+{	register hash_t *hp, *dp;
+	register int o, i;
+	unsigned r, c;
+
+	for( o = 0; o < Q_OFFSETS; o++ )
+	{	/* the stone is at this offset from the point r, c */
+		r = P_ROW( pt ) - q_dr[o] - 1;
+		c = P_COL( pt ) - q_dc[o] - 1;
+		if (r >= gp->g_size  ||  c >= gp->g_size)
+			continue;
+
+		hp = qp[ P_INDEX( r + 1, c + 1 ) ].q_ring[ q_dist[o] - 1 ][0];
+		dp = q_delta[color][o][0];
+		for( i = 0; i < 2 * Q_SYMS; i++ )
+			hp[i] ^= dp[i];
+	}
+}
+
+/*
+ * routine:
+ *	q_flip
+ *
+ * purpose:
+ *	to note that a stone has been placed on (or taken from) a point
+ *
+ * parms:
+ *	game in which the stone was placed
+ *	point of the stone
+ *	color of the stone
+ *
+ * note:
+ *	called by the engines, only for moves that keep the hashes
+ */
+void q_flip( struct game_ctx *gp, int pt, int color )
+{
+	q_xor( gp, gp->g_qpat, pt, color );
+}
+
+/*
+ * routine:
+ *	q_build
+ *
+ * purpose:
+ *	to work out the rings of every point from scratch
+ *
+ * parms:
+ *	game whose board they describe
+ *	where to put them
+ */
+void q_build( struct game_ctx *gp, struct qpoint *qp )
+{	register int pt, o, s;
+	register hash_t *hp;
+	int r;
+	unsigned rr, cc;
+
+	(void) memset( (char *) qp, 0, P_POINTS * sizeof (struct qpoint) );
+
+	/* the edges never move */
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			for( o = 0; o < Q_OFFSETS; o++ )
+			{	rr = P_ROW( pt ) + q_dr[o] - 1;
+				cc = P_COL( pt ) + q_dc[o] - 1;
+				if (rr < gp->g_size  &&  cc < gp->g_size)
+					continue;
+				hp = qp[pt].q_ring[ q_dist[o] - 1 ][0];
+				for( s = 0; s < Q_SYMS; s++ )
+				{	hp[s] ^= q_keys[Q_EDGE][ q_sym[s][o] ];
+					hp[ Q_SYMS + s ] ^= q_keys[Q_EDGE][ q_sym[s][o] ];
+				}
+			}
+
+	/* and then the stones */
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if (gp->g_str[pt].s_moveno > 0)
+				q_xor( gp, qp, pt, gp->g_str[pt].s_color );
+}
+
+/*
+ * routine:
+ *	q_attach
+ *
+ * purpose:
+ *	to start keeping the pattern hashes of a game
+ *
+ * parms:
+ *	game whose hashes are to be kept
+ *
+ * note:
+ *	the hashes are worked out for the stones already on the board, so
+ *	every move already made is marked as having kept them, so that
+ *	it will take its stones out of them again when it is taken back.
+ */
+void q_attach( struct game_ctx *gp )
+{	register int n;
+
+	q_init();
+	if (gp->g_qpat == 0)
+	{	gp->g_qpat = (struct qpoint *) malloc( P_POINTS * sizeof (struct qpoint) );
+		if (gp->g_qpat == 0)
+		{	d_msg( "Unable to allocate pattern hashes" );
+			return;
+		}
+	}
+
+	q_build( gp, gp->g_qpat );
+	for( n = 1; n < gp->g_movenum; n++ )
+		MOVE( gp, n )->m_flags |= M_PATTERN;
+}
+
+/*
+ * routine:
+ *	q_reset
+ *
+ * purpose:
+ *	to reset the pattern hashes of a game to those of an empty board
+ *
+ * parms:
+ *	game being reset
+ *
+ * note:
+ *	a game that has no hashes is given them if there is a database
+ */
+void q_reset( struct game_ctx *gp )
+{
+	if (gp->g_qpat  ||  q_count > 0)
+		q_attach( gp );
+}
+
+/*
+ * routine:
+ *	q_release
+ *
+ * purpose:
+ *	to give back the pattern hashes of a game that is going away
+ *
+ * parms:
+ *	game being released
+ */
+void q_release( struct game_ctx *gp )
+{
+	if (gp->g_qpat)
+		free( (char *) gp->g_qpat );
+	gp->g_qpat = 0;
+}
+
+/*
+ * routine:
+ *	q_hashes
+ *
+ * purpose:
+ *	to find the canonical hashes of the patterns around a point
+ *
+ * parms:
+ *	game in which the point is found
+ *	point at the center of the patterns
+ *	color of the player to move
+ *	where to put the hashes (for radius Q_MINDIST on up)
+ *
+ * note:
+ *	hashes are never zero, which would mark a free slot in the table
+ */
+static void q_hashes( struct game_ctx *gp, int pt, int color, hash_t *hashes )
+{	register hash_t *hp;
+	register int d, s;
+	hash_t h[ Q_SYMS ];
+	hash_t best;
+
+	for( s = 0; s < Q_SYMS; s++ )
+		h[s] = 0;
+
+	for( d = 0; d < Q_MAXDIST; d++ )
+	{	hp = gp->g_qpat[pt].q_ring[d][color];
+		best = h[0] ^= hp[0];
+		for( s = 1; s < Q_SYMS; s++ )
+			if ((h[s] ^= hp[s]) < best)
+				best = h[s];
+		if (d + 1 >= Q_MINDIST)
+			hashes[ d + 1 - Q_MINDIST ] = (best ^ q_rkeys[d]) | 1;
+	}
+}
+
+/*
+ * routine:
+ *	q_find
+ *
+ * purpose:
+ *	to look a pattern up in the database
+ *
+ * parms:
+ *	canonical hash of the pattern
+ *
+ * returns:
+ *	pointer to its entry
+ *	0 - it is not there
+ */
+static struct qentry *q_find( hash_t key )
+{	register struct qentry *tp = q_table;
+	register int i;
+
+	if (q_count == 0)
+		return( 0 );
+
+	for( i = (int) key & q_mask; tp[i].q_key != key; i = (i + 1) & q_mask )
+		if (tp[i].q_key == 0)
+			return( 0 );
+	return( &tp[i] );
+}
+
+/*
+ * routine:
+ *	q_grow
+ *
+ * purpose:
+ *	to double the size of the database (or create it)
+ *
+ * returns:
+ *	TRUE	table was enlarged
+ *	FALSE	unable to allocate a larger table
+ */
+static int q_grow()
+{	register struct qentry *ep, *np;
+	register int i;
+	int size = q_table ? 2 * (q_mask + 1) : Q_MINSIZE;
+
+	np = (struct qentry *) calloc( size, sizeof (struct qentry) );
+	if (np == 0)
+		return( FALSE );
+
+	/* re-enter every pattern into the new table */
+	if (q_table)
+	{	for( ep = q_table; ep <= &q_table[ q_mask ]; ep++ )
+		{	if (ep->q_key == 0)
+				continue;
+			for( i = (int) ep->q_key & (size - 1); np[i].q_key;
+					i = (i + 1) & (size - 1) );
+			np[i] = *ep;
+		}
+		free( (char *) q_table );
+	}
+
+	q_table = np;
+	q_mask = size - 1;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	q_enter
+ *
+ * purpose:
+ *	to find a pattern's entry in the database, making one if need be
+ *
+ * parms:
+ *	canonical hash of the pattern
+ *
+ * returns:
+ *	pointer to its entry
+ *	0 - the table is full
+ */
+static struct qentry *q_enter( hash_t key )
+{	register struct qentry *ep;
+	register int i;
+
+	if ((ep = q_find( key )) != 0)
+		return( ep );
+
+	/* keep the table no more than half full */
+	if ((q_table == 0  ||  2 * (q_count + 1) > q_mask + 1)  &&  !q_grow())
+		return( 0 );
+
+	for( i = (int) key & q_mask; q_table[i].q_key; i = (i + 1) & q_mask );
+	ep = &q_table[i];
+	ep->q_key = key;
+	ep->q_played = 0;
+	ep->q_seen = 0;
+	q_count++;
+	return( ep );
+}
+
+/*
+ * routine:
+ *	q_rate
+ *
+ * purpose:
+ *	to rate a move by the patterns around it
+ *
+ * parms:
+ *	game in which the move would be made
+ *	point of the move (vacant)
+ *	color of the player who would make it
+ *
+ * returns:
+ *	how often the move was played when the largest pattern around it
+ *	that has been seen often enough was found, in Q_SCALEths
+ *	-1 - no such pattern is known (or the game keeps no hashes)
+ */
+int q_rate( struct game_ctx *gp, int pt, int color )
+{	register struct qentry *ep;
+	register int k;
+	hash_t hashes[ Q_MAXDIST - Q_MINDIST + 1 ];
+
+	if (gp->g_qpat == 0  ||  q_count == 0)
+		return( -1 );
+
+	q_hashes( gp, pt, color, hashes );
+	for( k = Q_MAXDIST - Q_MINDIST; k >= 0; k-- )
+		if ((ep = q_find( hashes[k] )) != 0  &&  ep->q_seen >= Q_MINSEEN)
+			return( (int) ((long) ep->q_played * Q_SCALE / ep->q_seen) );
+
+	return( -1 );
+}
+
+/*
+ * routine:
+ *	q_learn
+ *
+ * purpose:
+ *	to learn the patterns of the moves played in a game
+ *
+ * parms:
+ *	game to be learned from
+ *
+ * returns:
+ *	number of positions learned from
+ *	-1 - the database is full
+ *
+ * note:
+ *	the game is replayed (with the light engine) in a game of its own.
+ *	Before each move, the patterns around every vacant point are
+ *	counted as seen, and those around the move as played.
+ */
+int q_learn( struct game_ctx *gp )
+{	register struct qentry *ep;
+	register int pt, k;
+	struct game_ctx *lp;
+	struct move *mp;
+	int n, r, color, move, learned;
+	hash_t hashes[ Q_MAXDIST - Q_MINDIST + 1 ];
+
+	if ((lp = g_new( gp->g_size )) == 0)
+		return( 0 );
+	q_attach( lp );
+	if (lp->g_qpat == 0)
+	{	g_free( lp );
+		return( 0 );
+	}
+	lp->g_engine = lp->g_engine->e_light;
+	lp->g_qtrack = TRUE;
+
+	learned = 0;
+	for( n = 1; n < gp->g_movenum; n++ )
+	{	mp = MOVE( gp, n );
+		color = mp->m_flags & M_COLOR;
+		move = mp->m_pos.row_col ? mp->m_point : 0;
+
+		if (move)
+		{	for( r = 1; r <= lp->g_size; r++ )
+				for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, lp->g_size ); pt++ )
+				{	if (lp->g_str[pt].s_moveno != 0)
+						continue;
+					q_hashes( lp, pt, color, hashes );
+					for( k = 0; k <= Q_MAXDIST - Q_MINDIST; k++ )
+					{	if ((ep = q_enter( hashes[k] )) == 0)
+						{	g_free( lp );
+							return( -1 );
+						}
+						ep->q_seen++;
+						if (pt == move)
+							ep->q_played++;
+					}
+				}
+			learned++;
+		}
+
+		lp->g_nxtcolor = color;
+		if (!p_make( lp, move ))
+			break;
+	}
+
+	g_free( lp );
+	return( learned );
+}
+
+/*
+ * routine:
+ *	q_load
+ *
+ * purpose:
+ *	to read a pattern database, adding it to the one we have
+ *
+ * parms:
+ *	name of the file
+ *	TRUE if a missing file should be complained about
+ *
+ * returns:
+ *	number of patterns read
+ *	-1 - the file could not be read
+ */
+int q_load( char *file, int loud )
+{	register struct qentry *ep;
+	FILE *infile;
+	char line[ MAXLINE ];
+	hash_t key;
+	int played, seen, n;
+
+	if ((infile = fopen( file, "r" )) == NULL)
+	{	if (loud)
+			d_msg( "Unable to open pattern file: %s", file );
+		return( -1 );
+	}
+
+	n = 0;
+	while( fgets( line, MAXLINE, infile ) != NULL )
+	{	if (line[0] == '#')
+			continue;
+		if (sscanf( line, "%llx %d %d", &key, &played, &seen ) != 3  ||
+			key == 0)
+			continue;
+		if ((ep = q_enter( key )) == 0)
+		{	d_msg( "*** pattern table is full" );
+			break;
+		}
+		ep->q_played += played;
+		ep->q_seen += seen;
+		n++;
+	}
+
+	(void) fclose( infile );
+	return( n );
+}
+
+/*
+ * routine:
+ *	q_save
+ *
+ * purpose:
+ *	to write the pattern database out to a file
+ *
+ * parms:
+ *	name of the file
+ *
+ * returns:
+ *	number of patterns written
+ *	-1 - the file could not be created
+ */
+int q_save( char *file )
+{	register struct qentry *ep;
+	FILE *outfile;
+	extern char *version;
+	int n = 0;
+
+	if ((outfile = fopen( file, "w" )) == NULL)
+	{	d_msg( "Unable to create pattern file: %s", file );
+		return( -1 );
+	}
+
+	fprintf( outfile, "# GO pattern database, %s\n", version );
+	fprintf( outfile, "#   pattern hash, times played, times seen\n" );
+	if (q_table)
+		for( ep = q_table; ep <= &q_table[ q_mask ]; ep++ )
+			if (ep->q_key)
+			{	fprintf( outfile, "%016llx %d %d\n", ep->q_key,
+					ep->q_played, ep->q_seen );
+				n++;
+			}
+
+	(void) fclose( outfile );
+	return( n );
+}
+
+/*
+ * routine:
+ *	q_clear
+ *
+ * purpose:
+ *	to forget every pattern in the database
+ */
+void q_clear()
+{
+	if (q_table)
+		free( (char *) q_table );
+	q_table = 0;
+	q_mask = 0;
+	q_count = 0;
+}
+
+/*
+ * routine:
+ *	q_show
+ *
+ * purpose:
+ *	to display the rating of every move for the player to move (the
+ *	e p command), in percent
+ *
+ * parms:
+ *	game to be displayed
+ *
+ * note:
+ *	the best rated moves are shown as special
+ */
+void q_show( struct game_ctx *gp )
+{	register int pt, r;
+	int rate, best, color = gp->g_nxtcolor;
+
+	for( best = 0, r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if (gp->g_str[pt].s_moveno == 0  &&
+				(rate = q_rate( gp, pt, color )) > best)
+				best = rate;
+
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if (gp->g_str[pt].s_moveno == 0  &&
+				(rate = q_rate( gp, pt, color )) >= 0)
+				d_value( r, P_COL( pt ), color,
+					rate == best ? B_SPECIAL : B_ARMY,
+					rate * 100 / Q_SCALE );
+	d_update();
+}
+
+/*
+ * routine:
+ *	c_patterns
+ *
+ * purpose:
+ *	to learn, read, write and forget patterns (the l command)
+ *
+ * parms:
+ *	argument string
+ *		(none)	 learn the patterns of the moves of this game
+ *		r <file> read patterns from a file (adding them in)
+ *		w <file> write the patterns out to a file
+ *		c	 forget all of the patterns
+ *	files default to Q_DEFFILE
+ */
+void c_patterns( char *arg )
+{	register char *s;
+	int n;
+
+	s_ponder( cur_game, FALSE );
+
+	/* find the file name, if any */
+	for( s = arg; s && *s && *s != ' ' && *s != '\t'; s++ );
+	while( s && (*s == ' ' || *s == '\t') )
+		s++;
+	if (s == 0  ||  *s == 0)
+		s = Q_DEFFILE;
+
+	switch( arg ? *arg : 0 )
+	{ case 0:	/* learn from this game */
+		if ((n = q_learn( cur_game )) < 0)
+			d_msg( "*** pattern table is full" );
+		else
+			d_msg( "Patterns learned from %d positions, %d known",
+				n, q_count );
+		break;
+
+	  case 'r':	/* read a database */
+		if ((n = q_load( s, TRUE )) >= 0)
+			d_msg( "%d patterns read from %s, %d known", n, s, q_count );
+		break;
+
+	  case 'w':	/* write the database */
+		if ((n = q_save( s )) >= 0)
+			d_msg( "%d patterns written to %s", n, s );
+		return;
+
+	  case 'c':	/* forget the database */
+		q_clear();
+		d_msg( "All patterns forgotten" );
+		return;
+
+	  default:
+		d_msg( "Unrecognized pattern request: %s", arg );
+		return;
+	}
+
+	/* the game at the console can now use them */
+	if (q_count > 0)
+		q_attach( cur_game );
+}
@@ -0,0 +1,79 @@
+/*
+ * module:
+ *	pattern.h
+ *
+ * purpose:
+ *	to describe the hashes of the large patterns around each point,
+ *	and the database of patterns learned from games
+ */
+
+/*
+ * A large pattern is the diamond of points within some distance of a
+ * vacant point (counting steps along the lines, not diagonals), seen
+ * by the player to move: each point holds a stone of that player, an
+ * enemy stone, nothing, or lies off the edge of the board.  Patterns
+ * of each radius from Q_MINDIST to Q_MAXDIST are matched, and a larger
+ * one, being rarer, says more about a move when it has been seen often
+ * enough.
+ *
+ * The hash of a pattern is the exclusive-or of a random key for what
+ * is found at each point of the diamond and where it lies.  Rotating
+ * or reflecting the board (eight ways) moves the points around, so the
+ * same pattern has up to eight hashes; the least of them (with a key
+ * for the radius) is the pattern's canonical hash, which is the same
+ * however the pattern is turned.  Keys are for the player to move and
+ * the enemy, rather than black and white, so a pattern and the same
+ * pattern with the colors swapped (and the other player to move) have
+ * the same hash as well.
+ *
+ * Since hashes are made with exclusive-or, each game keeps (in g_qpat)
+ * the hashes of the rings of points at each distance from every point,
+ * under each of the eight symmetries and for each player to move.  A
+ * stone placed on (or taken from) the board is xor'ed into the rings
+ * of every point within Q_MAXDIST of it (see q_flip), and the hashes of
+ * all of the patterns around a point can then be had by xor'ing its
+ * rings together, with no need to look at the board.
+ *
+ * Keeping the hashes is not cheap, so a game only has them when there
+ * is a pattern database to match against (or patterns are being
+ * learned).  The full engines then keep them for every move.  The light
+ * engines only keep them while g_qtrack is set, which the search does
+ * for the moves it makes down the tree, but not for its playouts or
+ * reading.  A move records (with M_PATTERN) whether it was kept, so it
+ * is taken back the same way.
+ */
+#define Q_MINDIST	2	/* radius of the smallest pattern matched */
+#define Q_MAXDIST	4	/* radius of the largest */
+#define Q_SYMS		8	/* rotations and reflections of the board */
+#define Q_OFFSETS	(2 * Q_MAXDIST * (Q_MAXDIST + 1)) /* points in the largest */
+
+/* what may be found at a point, from the point of view of the player
+ * to move */
+#define Q_OWN		0	/* a stone of the player to move */
+#define Q_ENEMY		1	/* an enemy stone */
+#define Q_EDGE		2	/* off the edge of the board */
+
+/* the rings around a point: hashes of the points at each distance, for
+ * each player to move and each symmetry */
+struct qpoint
+{	hash_t	q_ring[ Q_MAXDIST ][2][ Q_SYMS ];
+};
+
+/*
+ * The database is an open hash table of canonical hashes, giving for
+ * each pattern the number of times it was found around a vacant point
+ * in the positions learned from, and the number of times the move was
+ * played there.  A hash of zero marks a free slot.  It is read from
+ * (and written to) a file of lines, each with a hash (in hex) and the
+ * two counts, and is kept no more than half full.
+ */
+struct qentry
+{	hash_t	q_key;		/* canonical hash (0 - free) */
+	int	q_played;	/* times the move was played there */
+	int	q_seen;		/* times the pattern was found */
+};
+
+#define Q_MINSIZE	4096	/* initial size of the table (power of 2) */
+#define Q_MINSEEN	4	/* times a pattern must be seen to be trusted */
+#define Q_SCALE		1000	/* ratings are in thousandths */
+#define Q_DEFFILE	"go.pat" /* database read when the program starts */
@@ -0,0 +1,447 @@
+/*
+ * module:
+ *	playout.c
+ *
+ * purpose:
+ *	to play games out quickly, with random moves, to the end
+ *
+ * note:
+ *	a playout plays random legal moves (other than moves that would
+ *	fill one of the mover's own eyes) for both sides, until both sides
+ *	pass in succession.  The final position is scored by area, and then
+ *	the whole playout is taken back, leaving the game as it was found.
+ *	Playouts are made with the game's light engine (see engine.h), so
+ *	they update neither the display nor the move log, and are not
+ *	traced.  Only simple ko is respected within a playout.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+
+/*
+ * random numbers for playouts.  Each caller supplies its own seed, so
+ * that independent playouts need not share (or lock) a generator.  The
+ * generator is a simple linear congruential one, from whose high order
+ * bits we take a number in the range 0 - (n-1).
+ */
+#define P_RAND(seed)	((*(seed) = *(seed) * 1103515245L + 12345) >> 16 & 0x7fff)
+#define P_RANGE(seed,n)	((int) ((P_RAND( seed ) * (long) (n)) >> 15))
+
+/* for each set of states of the points around a point (see strings.h),
+ * the colors for which it is an eye, as a mask of (1 << color) */
+static char p_eyes[ X_STATES + 1 ];
+
+/*
+ * routine:
+ *	p_init
+ *
+ * purpose:
+ *	to fill in the table of eyes
+ *
+ * note:
+ *	a point is an eye if all of its neighbors are friendly stones (or
+ *	the edge), and the enemy holds at most one of its diagonal points
+ *	(none, on the edge of the board).  This is the usual playout rule
+ *	of thumb, and can be fooled by false eyes in unusual shapes.  The
+ *	table only needs to be built once, no matter how many games are
+ *	created.
+ */
+void p_init()
+{	static int done;
+	register long code;
+	register int i, color;
+	int edge, enemy, state;
+
+	if (done)
+		return;
+
+	for( code = 0; code <= X_STATES; code++ )
+	{	p_eyes[code] = 0;
+		for( color = BLACK; color <= WHITE; color++ )
+		{	edge = enemy = 0;
+			for( i = 0; i < 8; i++ )
+			{	state = X_STATE( code, i );
+				if ((i & 1) == 0)
+				{	if (state != X_EDGE  &&  state != X_STONE( color ))
+						break;
+				} else if (state == X_EDGE)
+					edge = 1;
+				else if (state == X_STONE( !color ))
+					enemy++;
+			}
+			if (i == 8  &&  enemy + edge < 2)
+				p_eyes[code] |= 1 << color;
+		}
+	}
+
+	done = TRUE;
+}
+
+/*
+ * routine:
+ *	p_eye
+ *
+ * purpose:
+ *	to decide whether or not a vacant point is an eye for a color
+ *
+ * parms:
+ *	game in which the point is found
+ *	point number
+ *	color of the player who might fill it
+ *
+ * returns:
+ *	TRUE	the point is (probably) an eye, and should not be filled
+ *	FALSE	the point is not an eye
+ *
+ * note:
+ *	the point's pattern code is looked up in the table of eyes (see
+ *	p_init).
+ */
+int p_eye( struct game_ctx *gp, int pt, int color )
+{
+	return( p_eyes[ gp->g_pat[pt] ] >> color & 1 );
+}
+
+/*
+ * routine:
+ *	p_legal
+ *
+ * purpose:
+ *	to see whether the player to move may play at a point
+ *
+ * parms:
+ *	game in which the move would be made
+ *	point number
+ *
+ * returns:
+ *	TRUE	the move is legal (and has been estimated)
+ *	FALSE	the move would retake a ko, or be suicide
+ *
+ * note:
+ *	the move is estimated in the next entry of the move table, which
+ *	the caller must have obtained (from h_newmove).  Superko is not
+ *	checked.
+ */
+int p_legal( struct game_ctx *gp, int pt )
+{	register struct move *mp = MOVE( gp, gp->g_movenum );
+
+	mp->m_flags = gp->g_nxtcolor * M_COLOR;
+	mp->m_pos.sub.row = P_ROW( pt );
+	mp->m_pos.sub.col = P_COL( pt );
+	if (mp->m_pos.row_col == MOVE( gp, gp->g_movenum - 1 )->m_ko.row_col)
+		return( FALSE );
+
+	m_estimate( gp, mp );
+	return( mp->m_libs > 0  ||  mp->m_kills > 0 );
+}
+
+/*
+ * routine:
+ *	p_make
+ *
+ * purpose:
+ *	to make a move for the player whose turn it is
+ *
+ * parms:
+ *	game in which the move is to be made
+ *	point number (0 - pass)
+ *
+ * returns:
+ *	TRUE	the move was made
+ *	FALSE	the move is illegal (see p_legal), or the game is too long
+ *
+ * note:
+ *	the move is made with the game's current engine, and is neither
+ *	logged nor displayed.  It should be taken back with p_back.
+ */
+int p_make( struct game_ctx *gp, int pt )
+{	register struct move *mp;
+
+	if ((mp = h_newmove( gp )) == 0)
+		return( FALSE );
+
+	if (pt == 0)
+	{	mp->m_flags = gp->g_nxtcolor * M_COLOR;
+		mp->m_pos.row_col = 0;
+		mp->m_point = 0;
+		mp->m_ko.row_col = 0;
+	} else
+	{	if (!p_legal( gp, pt ))
+			return( FALSE );
+		m_do( gp, mp );
+	}
+
+	gp->g_nxtcolor = (gp->g_nxtcolor == WHITE) ? BLACK : WHITE;
+	gp->g_movenum++;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	p_back
+ *
+ * purpose:
+ *	to take back moves made by p_make (or in a playout)
+ *
+ * parms:
+ *	game in which the moves were made
+ *	number of the first move to be taken back
+ */
+void p_back( struct game_ctx *gp, int first )
+{	register struct move *mp;
+
+	while( gp->g_movenum > first )
+	{	gp->g_movenum--;
+		mp = MOVE( gp, gp->g_movenum );
+		if (mp->m_pos.row_col)
+			m_unmove( gp, mp );
+		gp->g_nxtcolor = mp->m_flags & M_COLOR;
+	}
+}
+
+/*
+ * routine:
+ *	p_move
+ *
+ * purpose:
+ *	to make a random move in a playout
+ *
+ * parms:
+ *	game in which the move is to be made
+ *	list of vacant points (updated to reflect the move)
+ *	number of points in that list (also updated)
+ *	random number seed
+ *
+ * returns:
+ *	TRUE	a stone was played
+ *	FALSE	the player had no sensible move, and passed
+ *
+ * note:
+ *	we start at a random point in the list of vacancies, and take the
+ *	first acceptable move after it (wrapping around to the start).
+ */
+static int p_move( struct game_ctx *gp, short *empty, int *nempty, unsigned long *seed )
+{	register struct move *mp;
+	register struct move *np;
+	register short *sp;
+	register int pt;
+	int color = gp->g_nxtcolor;
+	int n = *nempty;
+	int i, tries;
+
+	mp = MOVE( gp, gp->g_movenum );
+
+	for( i = n ? P_RANGE( seed, n ) : 0, tries = n; tries > 0; tries-- )
+	{	pt = empty[i];
+		if (++i == n)
+			i = 0;
+
+		/* don't fill our own eyes */
+		if (p_eye( gp, pt, color ))
+			continue;
+
+		/* the move must be legal: neither retaking a ko nor suicide */
+		if (!p_legal( gp, pt ))
+			continue;
+
+		/* make the move, and take its point off of the vacant list */
+		m_do( gp, mp );
+		i = (i == 0) ? n - 1 : i - 1;
+		empty[i] = empty[--n];
+
+		/* the stones it killed leave vacancies behind them */
+		if (mp->m_kills)
+			for( sp = mp->m_neighbor; sp < &mp->m_neighbor[4] && *sp; sp++ )
+			{	if (*sp > 0)
+					continue;
+				np = MOVE( gp, -*sp );
+				if (np->m_libs)
+					continue;
+				pt = np->m_point;
+				do
+				{	empty[n++] = pt;
+					pt = gp->g_str[pt].s_next;
+				} while( pt != np->m_point );
+			}
+
+		*nempty = n;
+		return( TRUE );
+	}
+
+	/* nothing we are willing to play, so we pass */
+	mp->m_flags = color * M_COLOR;
+	mp->m_pos.row_col = 0;
+	mp->m_point = 0;
+	mp->m_ko.row_col = 0;
+	return( FALSE );
+}
+
+/*
+ * routine:
+ *	p_score
+ *
+ * purpose:
+ *	to score a finished playout by area
+ *
+ * parms:
+ *	game to be scored
+ *
+ * returns:
+ *	white's area less black's (positive favors white), without komi
+ *
+ * note:
+ *	a vacant point counts for a player if all of the stones around
+ *	its region are that player's.  At the end of a playout, nearly all
+ *	vacant points are eyes, so the regions are quickly found here (the
+ *	light engines do not keep the region board, see strings.h).  Points
+ *	held for good (see benson.c) count for the player who holds them,
+ *	whatever is on them, since nobody plays on them in playouts.
+ */
+int p_score( struct game_ctx *gp )
+{	register struct string *sp;
+	register int pt, q, i;
+	int r, seen, size, nstack;
+	int score = 0;
+	char done[ P_POINTS ];
+	short stack[ MAXBOARD * MAXBOARD ];
+
+	(void) memset( done, 0, sizeof done );
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	if (gp->g_safe[pt])
+			{	score += U_SAFE( gp, pt, WHITE ) ? 1 : -1;
+				continue;
+			}
+
+			sp = &gp->g_str[pt];
+			if (sp->s_moveno > 0)
+			{	score += (sp->s_color == WHITE) ? 1 : -1;
+				continue;
+			}
+			if (done[pt])
+				continue;
+
+			/* find its region, and whose stones (if anyone's)
+			 * surround it */
+			seen = size = 0;
+			done[pt] = TRUE;
+			stack[0] = pt;
+			nstack = 1;
+			while( nstack > 0 )
+			{	q = stack[ --nstack ];
+				if (gp->g_safe[q] == 0)
+					size++;
+				for( i = 0; i < 4; i++ )
+				{	sp = &gp->g_str[ q + p_adj[i] ];
+					if (sp->s_moveno > 0)
+						seen |= 1 << sp->s_color;
+					else if (sp->s_moveno == 0  &&  !done[ q + p_adj[i] ])
+					{	done[ q + p_adj[i] ] = TRUE;
+						stack[ nstack++ ] = q + p_adj[i];
+					}
+				}
+			}
+			if (seen == (1 << WHITE))
+				score += size;
+			else if (seen == (1 << BLACK))
+				score -= size;
+		}
+
+	return( score );
+}
+
+/*
+ * routine:
+ *	p_playout
+ *
+ * purpose:
+ *	to play a game out from its current position, and score it
+ *
+ * parms:
+ *	game to be played out (left as it was found)
+ *	random number seed
+ *
+ * returns:
+ *	final area score (positive favors white), without komi
+ */
+int p_playout( struct game_ctx *gp, unsigned long *seed )
+{	register int pt, r;
+	struct engine *ep = gp->g_engine;
+	int first = gp->g_movenum;
+	int passes = 0;
+	int limit, nempty, score;
+	short empty[ MAXBOARD * MAXBOARD ];
+
+	/* note all of the vacant points, other than those held for good */
+	nempty = 0;
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+			if (gp->g_str[pt].s_moveno == 0  &&  gp->g_safe[pt] == 0)
+				empty[ nempty++ ] = pt;
+
+	/* play until both sides pass, or the game gets silly */
+	gp->g_engine = ep->e_light;
+	limit = first + 3 * gp->g_size * gp->g_size;
+	while( passes < 2  &&  gp->g_movenum < limit )
+	{	if (h_newmove( gp ) == 0)
+			break;
+		if (p_move( gp, empty, &nempty, seed ))
+			passes = 0;
+		else
+			passes++;
+		gp->g_nxtcolor = (gp->g_nxtcolor == WHITE) ? BLACK : WHITE;
+		gp->g_movenum++;
+	}
+
+	score = p_score( gp );
+
+	/* and take it all back */
+	p_back( gp, first );
+	gp->g_engine = ep;
+
+	return( score );
+}
+
+/*
+ * routine:
+ *	p_speed
+ *
+ * purpose:
+ *	to time a number of playouts from the current position
+ *
+ * parms:
+ *	game to be played out
+ *	number of playouts to be made
+ */
+void p_speed( struct game_ctx *gp, int count )
+{	register int i;
+	unsigned long seed = 1;
+	long total = 0;
+	int wwins = 0;
+	int score;
+	clock_t start, ticks;
+
+	if (count <= 0)
+		count = 1000;
+
+	start = clock();
+	for( i = 0; i < count; i++ )
+	{	score = p_playout( gp, &seed );
+		total += score;
+		if (score > 0)
+			wwins++;
+	}
+	ticks = clock() - start;
+	if (ticks <= 0)
+		ticks = 1;
+
+	d_msg( "%d playouts, %ld/sec: white wins %d%%, by %ld avg (no komi)",
+		count, (long) (count * (double) CLOCKS_PER_SEC / ticks),
+		(int) (100L * wwins / count), total / count );
+}
@@ -0,0 +1,364 @@
+/*
+ * module:
+ *	read.c
+ *
+ * purpose:
+ *	to read out the tactical fate of strings: can a string be
+ *	captured, and if so, can it be saved?
+ *
+ * note:
+ *	reading is done by making fantasy moves in the game with its
+ *	light engine (see engine.h), which are neither displayed nor
+ *	logged, and taking them back again.  The search is depth first,
+ *	and limited both in depth and in the number of positions looked at.
+ *	Only strings with few liberties are attacked: the attacker tries
+ *	the string's liberties, and the defender tries extending at them
+ *	and capturing the strings next to it that are in atari (and
+ *	passing, to see whether anything need be done at all).  A string
+ *	that gets three liberties has escaped, at any depth.  A string
+ *	that is out of depth (or positions) is given up for dead only if
+ *	it is caught in a ladder (see ladder.c), so what can't be read out
+ *	is never called dead.  Only simple ko is respected.
+ *
+ *	Results are kept in the transposition table (see ttable.h),
+ *	under a key made from the position, the point asked about and the
+ *	question, with the depth to which they were read.  A question that
+ *	has been read as deeply before is answered from the table.  A
+ *	reading cut short by running out of positions is not kept.
+ */
+#include <stdio.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "zobrist.h"
+#include "ttable.h"
+
+#define R_DEPTH		8	/* plies read for each question */
+#define R_MAXNODES	4000	/* most positions looked at for each */
+#define R_ATTACKLIBS	3	/* most liberties a string can be attacked with */
+#define R_MAXCANDS	16	/* most moves tried in a position */
+
+/* questions, for the keys of the results */
+#define R_CAPTURE	0
+#define R_ESCAPE	1
+#define R_WON		0x0001	/* flag: the side asking gets its way */
+
+/* a key for a question about a string (the point key is scrambled, so
+ * that it cannot be mistaken for a stone's key) */
+#define R_KEY(gp,pt,q)	(T_KEY( (gp)->g_hash, (gp)->g_nxtcolor ) ^ \
+		(z_keys[q][pt] << 23 | z_keys[q][pt] >> 41) ^ 0x5bd1e9955bd1e995ULL)
+
+/* the state of one reading */
+struct reader
+{	struct game_ctx *r_game;	/* game being read */
+	int	r_nodes;		/* positions looked at so far */
+};
+
+static int r_attack( struct reader *rp, int pt, int depth, int *movep );
+static int r_defend( struct reader *rp, int pt, int depth, int *movep );
+
+/*
+ * routine:
+ *	r_libs
+ *
+ * purpose:
+ *	to list the liberties of a string
+ *
+ * parms:
+ *	game in which the string is found
+ *	move structure for the string
+ *	where to put them
+ *	most that are wanted
+ *
+ * returns:
+ *	number of liberties listed
+ */
+static int r_libs( struct game_ctx *gp, struct move *mp, short *list, int max )
+{	register lword_t w;
+	register int i, n;
+
+	for( i = n = 0; i < gp->g_libwords  &&  n < max; i++ )
+		for( w = mp->m_libset[i]; w  &&  n < max; w &= w - 1 )
+			list[ n++ ] = (i << L_WORDSHIFT) + L_LOWEST( w );
+
+	return( n );
+}
+
+/*
+ * routine:
+ *	r_cached
+ *
+ * purpose:
+ *	to look for the answer to a question in the transposition table
+ *
+ * parms:
+ *	key of the question
+ *	depth to which it must have been read
+ *	where to put the answer
+ *	where to put the move that goes with it
+ *
+ * returns:
+ *	TRUE	the answer was found
+ *	FALSE	the question must be read
+ */
+static int r_cached( hash_t key, int depth, int *wonp, int *movep )
+{	hash_t data;
+
+	if (!t_probe( key, &data )  ||  T_DEPTH( data ) < depth + 1)
+		return( FALSE );
+
+	*wonp = (T_FLAGS( data ) & R_WON) != 0;
+	if (movep)
+		*movep = T_VALUE( data );
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	r_attack
+ *
+ * purpose:
+ *	to see whether a string can be captured, with its enemy to move
+ *
+ * parms:
+ *	reading being done
+ *	point of one of the string's stones
+ *	plies left to read
+ *	where to put the capturing move
+ *
+ * returns:
+ *	TRUE	the string can be captured
+ *	FALSE	it cannot (as far as we can read)
+ */
+static int r_attack( struct reader *rp, int pt, int depth, int *movep )
+{	register struct game_ctx *gp = rp->r_game;
+	register int i;
+	struct move *mp = MOVE( gp, gp->g_str[pt].s_moveno );
+	int first = gp->g_movenum;
+	short libs[ R_ATTACKLIBS ];
+	int nlibs, won, move;
+	hash_t key;
+
+	/* a string in atari is simply taken (unless that retakes a ko) */
+	nlibs = r_libs( gp, mp, libs, R_ATTACKLIBS );
+	if (mp->m_libs == 1)
+	{	*movep = libs[0];
+		if (!p_make( gp, libs[0] ))
+			return( FALSE );
+		p_back( gp, first );
+		return( TRUE );
+	}
+	if (mp->m_libs > R_ATTACKLIBS)
+		return( FALSE );
+
+	key = R_KEY( gp, pt, R_CAPTURE );
+	if (r_cached( key, depth, &won, movep ))
+		return( won );
+
+	/* when we can read no further, only a ladder will do */
+	if (depth <= 0  ||  rp->r_nodes >= R_MAXNODES)
+	{	*movep = 0;
+		return( mp->m_libs == 2  &&  r_ladder( gp, pt ) );
+	}
+
+	won = FALSE;
+	move = 0;
+	for( i = 0; i < nlibs  &&  !won; i++ )
+	{	if (!p_make( gp, libs[i] ))
+			continue;
+		rp->r_nodes++;
+		if (!r_defend( rp, pt, depth - 1, movep ))
+		{	won = TRUE;
+			move = libs[i];
+		}
+		p_back( gp, first );
+	}
+
+	if (rp->r_nodes < R_MAXNODES)
+		t_store( key, depth + 1, won ? R_WON : 0, move );
+	*movep = move;
+	return( won );
+}
+
+/*
+ * routine:
+ *	r_defend
+ *
+ * purpose:
+ *	to see whether a string can be saved, with its owner to move
+ *
+ * parms:
+ *	reading being done
+ *	point of one of the string's stones (which may have been captured)
+ *	plies left to read
+ *	where to put the saving move (0 - none is needed)
+ *
+ * returns:
+ *	TRUE	the string can be saved
+ *	FALSE	it cannot
+ */
+static int r_defend( struct reader *rp, int pt, int depth, int *movep )
+{	register struct game_ctx *gp = rp->r_game;
+	register struct string *sp;
+	register int i, k, n;
+	struct move *mp, *np;
+	int first = gp->g_movenum;
+	int color, head, q, won, move, dummy;
+	short cands[ R_MAXCANDS ];
+	int ncands;
+	hash_t key;
+
+	*movep = 0;
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( FALSE );
+	mp = MOVE( gp, gp->g_str[pt].s_moveno );
+
+	/* three liberties are enough */
+	if (mp->m_libs >= R_ATTACKLIBS)
+		return( TRUE );
+
+	key = R_KEY( gp, pt, R_ESCAPE );
+	if (r_cached( key, depth, &won, movep ))
+		return( won );
+
+	/* perhaps the string is in no danger at all */
+	won = FALSE;
+	move = 0;
+	if (mp->m_libs > 1  &&  p_make( gp, 0 ))
+	{	won = !r_attack( rp, pt, depth, &dummy );
+		p_back( gp, first );
+	}
+
+	/* out of depth, a string in atari is dead only in a ladder */
+	if (!won  &&  mp->m_libs == 1  &&
+		(depth <= 0  ||  rp->r_nodes >= R_MAXNODES))
+		won = !r_ladder( gp, pt );
+
+	/* otherwise, it can run, or capture something next to it */
+	if (!won  &&  depth > 0  &&  rp->r_nodes < R_MAXNODES)
+	{	ncands = r_libs( gp, mp, cands, R_ATTACKLIBS );
+		color = gp->g_str[pt].s_color;
+		head = pt;
+		do
+		{	for( i = 0; i < 4; i++ )
+			{	sp = &gp->g_str[ pt + p_adj[i] ];
+				if (sp->s_moveno <= 0  ||  sp->s_color == color)
+					continue;
+				np = MOVE( gp, sp->s_moveno );
+				if (np->m_libs != 1  ||  r_libs( gp, np, &cands[ncands], 1 ) == 0)
+					continue;
+				for( k = 0; cands[k] != cands[ncands]; k++ )
+					;
+				if (k == ncands  &&  ncands < R_MAXCANDS - 1)
+					ncands++;
+			}
+			pt = gp->g_str[pt].s_next;
+		} while( pt != head );
+
+		for( n = 0; n < ncands  &&  !won; n++ )
+		{	if (!p_make( gp, cands[n] ))
+				continue;
+			rp->r_nodes++;
+			q = (gp->g_str[pt].s_moveno > 0) ?
+				MOVE( gp, gp->g_str[pt].s_moveno )->m_libs : 0;
+			if (q >= R_ATTACKLIBS  ||
+				(q > 1  &&  !r_attack( rp, pt, depth - 1, &dummy )))
+			{	won = TRUE;
+				move = cands[n];
+			}
+			p_back( gp, first );
+		}
+	}
+
+	if (rp->r_nodes < R_MAXNODES)
+		t_store( key, depth + 1, won ? R_WON : 0, move );
+	*movep = move;
+	return( won );
+}
+
+/*
+ * routine:
+ *	r_capture
+ *
+ * purpose:
+ *	to see whether a string can be captured, if its enemy moves first
+ *
+ * parms:
+ *	game in which the string is found
+ *	point of one of its stones
+ *	where to put the capturing move
+ *
+ * returns:
+ *	TRUE	the string can be captured
+ *	FALSE	it cannot (as far as we can read)
+ *
+ * note:
+ *	the game is left as it was found.  The caller must see that the
+ *	transposition table has been allocated (see t_init) if the results
+ *	are to be kept.
+ */
+int r_capture( struct game_ctx *gp, int pt, int *movep )
+{	struct engine *ep = gp->g_engine;
+	struct reader rd;
+	int first = gp->g_movenum;
+	int won = FALSE;
+
+	*movep = 0;
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( FALSE );
+
+	rd.r_game = gp;
+	rd.r_nodes = 0;
+	gp->g_engine = ep->e_light;
+	if (gp->g_nxtcolor != gp->g_str[pt].s_color  ||  p_make( gp, 0 ))
+	{	won = r_attack( &rd, pt, R_DEPTH, movep );
+		p_back( gp, first );
+	}
+	gp->g_engine = ep;
+
+	return( won );
+}
+
+/*
+ * routine:
+ *	r_escape
+ *
+ * purpose:
+ *	to see whether a string can be saved, if its owner moves first
+ *
+ * parms:
+ *	game in which the string is found
+ *	point of one of its stones
+ *	where to put the saving move (0 - none is needed)
+ *
+ * returns:
+ *	TRUE	the string can be saved
+ *	FALSE	it is dead (as far as we can read)
+ *
+ * note:
+ *	as for r_capture
+ */
+int r_escape( struct game_ctx *gp, int pt, int *movep )
+{	struct engine *ep = gp->g_engine;
+	struct reader rd;
+	int first = gp->g_movenum;
+	int won = FALSE;
+
+	*movep = 0;
+	if (gp->g_str[pt].s_moveno <= 0)
+		return( FALSE );
+
+	rd.r_game = gp;
+	rd.r_nodes = 0;
+	gp->g_engine = ep->e_light;
+	if (gp->g_nxtcolor == gp->g_str[pt].s_color  ||  p_make( gp, 0 ))
+	{	won = r_defend( &rd, pt, R_DEPTH, movep );
+		p_back( gp, first );
+	}
+	gp->g_engine = ep;
+
+	return( won );
+}
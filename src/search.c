@@ -0,0 +1,935 @@
+/*
+ * module:
+ *	search.c
+ *
+ * purpose:
+ *	to choose moves for the computer, by Monte Carlo tree search
+ *
+ * note:
+ *	each iteration of the search follows the most promising line of
+ *	play down the tree (by the UCT rule), plays the game out from the
+ *	end of that line (see playout.c), and credits the result to every
+ *	node along the line.  The move made most often from the root is the
+ *	one we choose.  All of the moves are made (and taken back) with the
+ *	light engine, so the search leaves no trace in the game.
+ *
+ *	The search is made by several threads at once (see search.h).  The
+ *	first works in the game itself, and each of the others in a copy
+ *	of it (see g_copy) that it keeps from one search to the next.
+ *
+ *	The tree is kept from move to move, following the game (see
+ *	s_follow), so each search starts with whatever earlier searches
+ *	learned about the position.  Once the computer has moved, threads
+ *	go on searching (pondering) in their copies of the game while the
+ *	opponent thinks, and that work is kept in the same way.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <math.h>
+#include <time.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+#include "engine.h"
+#include "search.h"
+#include "zobrist.h"
+#include "ttable.h"
+#include "pattern.h"
+
+int mc_playouts = 10000;	/* playouts per computer move */
+int mc_seconds = 0;		/* seconds per computer move (0 - count) */
+int mc_threads = 0;		/* threads to search with (0 - one per cpu) */
+int mc_ponder = TRUE;		/* search while the opponent thinks */
+double komi = 7.5;		/* points given to white for moving second */
+
+/* the search tree */
+static struct arena arenas[2];	/* the tree, and room to trim it into */
+static struct arena *s_tree = &arenas[0];	/* the arena in use */
+static struct line s_line[ S_MAXDEPTH ];	/* line down to the root */
+static int s_nline;		/* length of that line (0 - no tree) */
+static int s_root;		/* number of the root node */
+static int s_checked;		/* root's children checked for legality */
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the threads searching it */
+struct worker
+{	pthread_t w_thread;	/* the thread itself */
+	struct game_ctx *w_game; /* its copy of the game */
+	unsigned long w_seed;	/* its random numbers */
+};
+static struct worker workers[ S_MAXTHREADS ];
+static int s_started;		/* number of playouts started */
+static long s_deadline;		/* when a timed search should stop */
+static int s_nponder;		/* number of threads pondering */
+static volatile int s_halt;	/* threads should stop searching */
+
+/*
+ * routine:
+ *	s_now
+ *
+ * purpose:
+ *	to find out what time it is (in milliseconds) by the wall clock
+ *
+ * note:
+ *	the cpu clock won't do, since it counts the time of every thread
+ */
+static long s_now()
+{	struct timespec ts;
+
+	(void) clock_gettime( CLOCK_MONOTONIC, &ts );
+	return( ts.tv_sec * 1000L + ts.tv_nsec / 1000000L );
+}
+
+/*
+ * routine:
+ *	s_alloc
+ *
+ * purpose:
+ *	to allocate consecutive nodes in an arena
+ *
+ * parms:
+ *	arena to allocate them from
+ *	number of nodes needed (no more than S_CHUNK)
+ *
+ * returns:
+ *	number of the first of them
+ *	-1 - there is no more memory
+ *
+ * note:
+ *	chunks are allocated as they are needed, and kept for later searches
+ */
+static int s_alloc( struct arena *ap, int count )
+{	register int c, n;
+
+	pthread_mutex_lock( &s_lock );
+
+	/* the nodes must all be in one chunk */
+	c = ap->a_used >> S_CHUNKSHIFT;
+	if ((ap->a_used & (S_CHUNK-1)) + count > S_CHUNK)
+	{	c++;
+		ap->a_used = c << S_CHUNKSHIFT;
+	}
+
+	if (c >= ap->a_nchunks)
+	{	if (c >= S_MAXCHUNKS  ||  (ap->a_chunk[c] = (struct node *)
+				malloc( S_CHUNK * sizeof (struct node) )) == 0)
+		{	pthread_mutex_unlock( &s_lock );
+			return( -1 );
+		}
+		ap->a_nchunks = c + 1;
+	}
+
+	n = ap->a_used;
+	ap->a_used += count;
+	pthread_mutex_unlock( &s_lock );
+	return( n );
+}
+
+/*
+ * routine:
+ *	s_rootok
+ *
+ * purpose:
+ *	to see whether a move may really be played in the game
+ *
+ * parms:
+ *	game in which the move would be made
+ *	point number (0 - pass)
+ *
+ * returns:
+ *	TRUE	the move is legal, and is not a forbidden blunder
+ *	FALSE	the move is illegal (unlike p_legal, superko is checked)
+ */
+static int s_rootok( struct game_ctx *gp, int pt )
+{	int first = gp->g_movenum;
+	int ok;
+
+	if (pt == 0)
+		return( TRUE );
+	if (!p_make( gp, pt ))
+		return( FALSE );
+	ok = k_count( gp, gp->g_hash ) == 0;
+	if (no_blunders  &&  (MOVE( gp, first )->m_flags & M_BLUNDER))
+		ok = FALSE;
+	p_back( gp, first );
+	return( ok );
+}
+
+/*
+ * routine:
+ *	s_runs
+ *
+ * purpose:
+ *	to see whether a move merely runs from a ladder that works
+ *
+ * parms:
+ *	game in which the move would be made
+ *	point number
+ *	color of the player who would make it
+ *
+ * returns:
+ *	TRUE	the move extends a string in atari that would still be
+ *		captured in a ladder (see r_ladder)
+ *	FALSE	it does not
+ */
+static int s_runs( struct game_ctx *gp, int pt, int color )
+{	register struct string *sp;
+	register int i;
+
+	for( i = 0; i < 4; i++ )
+	{	sp = &gp->g_str[ pt + p_adj[i] ];
+		if (sp->s_moveno > 0  &&  sp->s_color == color  &&
+		    MOVE( gp, sp->s_moveno )->m_libs == 1  &&
+		    r_ladder( gp, pt + p_adj[i] ))
+			return( TRUE );
+	}
+
+	return( FALSE );
+}
+
+/*
+ * routine:
+ *	s_expand
+ *
+ * purpose:
+ *	to give a node a child for each of the moves that might follow it
+ *
+ * parms:
+ *	game, in the position after the node's move
+ *	number of the node to be expanded (already claimed by this thread)
+ *	TRUE if this is the root (the move we will actually play)
+ *
+ * note:
+ *	moves from the root must be legal in the real game, so they are
+ *	checked for superko, and must not be blunders if blunders are
+ *	forbidden.  Elsewhere, only simple ko is respected.
+ *
+ *	When the game keeps pattern hashes (see pattern.h), the children
+ *	are put in order of their patterns' ratings, so that the best of
+ *	them are tried first.
+ */
+static void s_expand( struct game_ctx *gp, int ni, int root )
+{	register struct node *np;
+	register int pt, r, k;
+	int color = gp->g_nxtcolor;
+	int nkids = 0;
+	int kids, i, rate;
+	short moves[ MAXBOARD * MAXBOARD ];
+	short rates[ MAXBOARD * MAXBOARD ];
+
+	if (h_newmove( gp ) == 0)
+		return;
+
+	/* find all of the moves worth considering */
+	for( r = 1; r <= gp->g_size; r++ )
+		for( pt = P_INDEX( r, 1 ); pt <= P_INDEX( r, gp->g_size ); pt++ )
+		{	if (gp->g_str[pt].s_moveno != 0  ||  gp->g_safe[pt]  ||
+				p_eye( gp, pt, color ))
+				continue;
+
+			if (root ? !s_rootok( gp, pt ) : !p_legal( gp, pt ))
+				continue;
+			if (s_runs( gp, pt, color ))
+				continue;
+
+			/* keeping them in order of their ratings */
+			rate = q_rate( gp, pt, color );
+			for( i = nkids++; i > 0  &&  rates[i-1] < rate; i-- )
+			{	moves[i] = moves[i-1];
+				rates[i] = rates[i-1];
+			}
+			moves[i] = pt;
+			rates[i] = rate;
+		}
+
+	/* with nothing else to do, we can always pass */
+	if (nkids == 0)
+		moves[ nkids++ ] = 0;
+
+	/* give them nodes, and only then show them to the other threads */
+	if ((kids = s_alloc( s_tree, nkids )) < 0)
+		return;
+	for( k = 0; k < nkids; k++ )
+	{	np = NODE( kids + k );
+		np->n_point = moves[k];
+		np->n_nkids = S_LEAF;
+		np->n_visits = 0;
+		np->n_wins = 0;
+	}
+
+	np = NODE( ni );
+	np->n_kids = kids;
+	__sync_synchronize();
+	np->n_nkids = nkids;
+}
+
+/*
+ * routine:
+ *	s_select
+ *
+ * purpose:
+ *	to choose which child of a node to explore next
+ *
+ * parms:
+ *	number of an expanded node
+ *
+ * returns:
+ *	number of the child with the best upper confidence bound on its
+ *	winning rate (or the first child that nobody has tried yet)
+ */
+static int s_select( int ni )
+{	register struct node *cp;
+	register int k;
+	struct node *np = NODE( ni );
+	double logn = log( (double) np->n_visits + 1 );
+	double value, best = -1;
+	int choice = np->n_kids;
+	int visits;
+
+	for( k = 0; k < np->n_nkids; k++ )
+	{	cp = NODE( np->n_kids + k );
+		if ((visits = cp->n_visits) == 0)
+			return( np->n_kids + k );
+
+		value = (double) cp->n_wins / visits
+			+ S_UCT * sqrt( logn / visits );
+		if (value > best)
+		{	best = value;
+			choice = np->n_kids + k;
+		}
+	}
+
+	return( choice );
+}
+
+/*
+ * routine:
+ *	s_iterate
+ *
+ * purpose:
+ *	to carry out one iteration of the search
+ *
+ * parms:
+ *	game, in the position at the root of the tree
+ *	random number seed
+ *
+ * note:
+ *	the record of each node on the line is also kept in the
+ *	transposition table, under the key of the node's position.  A node
+ *	visited for the first time starts out with (up to S_PRIOR visits'
+ *	worth of) the record of any other node for the same position, so
+ *	what is learned along one order of moves helps along the others.
+ *	Failing that, a node whose move is found in a known pattern (see
+ *	pattern.h) starts out with S_PATTERN visits, at least half of them
+ *	won (more for a move often played in its pattern), which are not
+ *	counted towards expanding it.  The moves down the tree keep the
+ *	pattern hashes, if the game has them; those of the playout do not.
+ */
+static void s_iterate( struct game_ctx *gp, unsigned long *seed )
+{	register struct node *np;
+	register int d;
+	int path[ S_MAXDEPTH ];
+	hash_t keys[ S_MAXDEPTH ];
+	int depth = 0;
+	int first = gp->g_movenum;
+	int color = gp->g_nxtcolor;
+	int ni = s_root;
+	int wwin, mover, visits, made, rate;
+	hash_t data;
+
+	/* follow the most promising line down to the edge of the tree */
+	path[ depth++ ] = ni;
+	(void) S_ADD( NODE( ni )->n_visits, S_VLOSS );
+	while( NODE( ni )->n_nkids > 0  &&  depth < S_MAXDEPTH )
+	{	ni = s_select( ni );
+		np = NODE( ni );
+		rate = (np->n_visits == 0  &&  np->n_point) ?
+			q_rate( gp, np->n_point, gp->g_nxtcolor ) : -1;
+		gp->g_qtrack = TRUE;
+		made = p_make( gp, np->n_point );
+		gp->g_qtrack = FALSE;
+		if (!made)
+			break;
+		keys[ depth ] = T_KEY( gp->g_hash, gp->g_nxtcolor );
+		path[ depth++ ] = ni;
+
+		/* a new node may know the position from another line of play */
+		if ((visits = S_ADD( np->n_visits, S_VLOSS )) == 0)
+		{	if (t_probe( keys[ depth-1 ], &data ))
+			{	d = (T_DEPTH( data ) < S_PRIOR) ? T_DEPTH( data ) : S_PRIOR;
+				(void) S_ADD( np->n_visits, d );
+				(void) S_ADD( np->n_wins, (int) ((long) T_VALUE( data ) * d / S_RATE) );
+				visits += d;
+			} else if (rate >= 0)
+			{	(void) S_ADD( np->n_visits, S_PATTERN );
+				(void) S_ADD( np->n_wins, (S_PATTERN * (Q_SCALE + rate)
+					+ Q_SCALE) / (2 * Q_SCALE) );
+			}
+		}
+
+		/* a leaf that has been here before is worth expanding */
+		if (visits >= S_VLOSS * (S_EXPAND-1)  &&
+		    np->n_nkids == S_LEAF  &&  S_CLAIM( np->n_nkids, S_LEAF, S_BUSY ))
+		{	s_expand( gp, ni, FALSE );
+			break;
+		}
+	}
+
+	/* see how the game turns out from there */
+	wwin = p_playout( gp, seed ) > komi;
+	p_back( gp, first );
+
+	/* and settle up with everyone on the way */
+	for( d = 0; d < depth; d++ )
+	{	np = NODE( path[d] );
+		(void) S_ADD( np->n_visits, 1 - S_VLOSS );
+		mover = (d & 1) ? color : !color;
+		if ((mover == WHITE) == wwin)
+			(void) S_ADD( np->n_wins, 1 );
+
+		/* and note what we now know about their positions */
+		if (d > 0  &&  (visits = np->n_visits) > 0)
+			t_store( keys[d], visits, 0,
+				(int) ((long) np->n_wins * S_RATE / visits) );
+	}
+}
+
+/*
+ * routine:
+ *	s_work
+ *
+ * purpose:
+ *	to search until the budget for this move is used up
+ *
+ * parms:
+ *	worker doing the searching
+ */
+static void *s_work( void *arg )
+{	register struct worker *wp = (struct worker *) arg;
+	register struct game_ctx *gp = wp->w_game;
+	struct engine *ep = gp->g_engine;
+	int n;
+
+	gp->g_engine = ep->e_light;
+	for( n = 0; !s_halt; n++ )
+	{	if (s_nponder)
+		{	if (s_tree->a_used >= S_PONDERMAX)
+				break;
+		} else if (mc_seconds > 0)
+		{	if ((n & 15) == 0  &&  s_now() >= s_deadline)
+				break;
+		} else if (S_ADD( s_started, 1 ) >= mc_playouts)
+			break;
+		s_iterate( gp, &wp->w_seed );
+	}
+	gp->g_engine = ep;
+	t_flush();
+
+	return( 0 );
+}
+
+/*
+ * routine:
+ *	s_newtree
+ *
+ * purpose:
+ *	to start a new tree, whose root is the current position of a game
+ *
+ * parms:
+ *	game whose position is to be searched
+ *
+ * returns:
+ *	TRUE	the tree is ready (its root has been expanded)
+ *	FALSE	there is no memory for the tree
+ *
+ * note:
+ *	whatever was in the old tree is released all at once
+ */
+static int s_newtree( struct game_ctx *gp )
+{	register struct node *root;
+	register struct line *lp = s_line;
+	struct engine *ep = gp->g_engine;
+
+	s_nline = 0;
+	s_tree->a_used = 0;
+	if ((s_root = s_alloc( s_tree, 1 )) != 0)
+		return( FALSE );
+	root = NODE( s_root );
+	root->n_point = 0;
+	root->n_nkids = S_BUSY;
+	root->n_visits = 0;
+	root->n_wins = 0;
+
+	gp->g_engine = ep->e_light;
+	s_expand( gp, s_root, TRUE );
+	gp->g_engine = ep;
+	if (root->n_nkids <= 0)
+		return( FALSE );
+
+	lp->l_node = s_root;
+	lp->l_movenum = gp->g_movenum;
+	lp->l_color = gp->g_nxtcolor;
+	lp->l_hash = gp->g_hash;
+	s_nline = 1;
+	s_checked = TRUE;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	s_copytree
+ *
+ * purpose:
+ *	to copy the descendants of a node into another arena
+ *
+ * parms:
+ *	arena to copy them into
+ *	number of the node (in the arena in use)
+ *	number of its copy (in the other arena)
+ *
+ * returns:
+ *	TRUE	all of them were copied
+ *	FALSE	there was no room (the copy has been cut short)
+ *
+ * note:
+ *	the recursion is no deeper than the tree, which is no deeper than
+ *	S_MAXDEPTH (see s_iterate).
+ */
+static int s_copytree( struct arena *ap, int from, int to )
+{	register struct node *np = NODE( from );
+	register struct node *cp = A_NODE( ap, to );
+	register int k;
+	int kids;
+
+	*cp = *np;
+	if (np->n_nkids <= 0)
+	{	cp->n_nkids = S_LEAF;
+		return( TRUE );
+	}
+
+	if ((kids = s_alloc( ap, np->n_nkids )) < 0)
+	{	cp->n_nkids = S_LEAF;
+		return( FALSE );
+	}
+	cp->n_kids = kids;
+
+	for( k = 0; k < np->n_nkids; k++ )
+		if (!s_copytree( ap, np->n_kids + k, kids + k ))
+		{	/* the children after this one are not there */
+			cp->n_nkids = k + 1;
+			return( FALSE );
+		}
+
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	s_trim
+ *
+ * purpose:
+ *	to release everything in the tree but the root and its descendants
+ *
+ * note:
+ *	the subtree is copied into the other arena, which then becomes the
+ *	one in use, and the old one is released (its chunks are kept for
+ *	the next time).  The line down to the root is forgotten.
+ */
+static void s_trim()
+{	register struct arena *ap;
+
+	ap = (s_tree == &arenas[0]) ? &arenas[1] : &arenas[0];
+	ap->a_used = 0;
+	if (s_alloc( ap, 1 ) != 0)
+		return;
+	(void) s_copytree( ap, s_root, 0 );
+	A_NODE( ap, 0 )->n_point = 0;
+
+	s_tree->a_used = 0;
+	s_tree = ap;
+	s_line[0] = s_line[ s_nline-1 ];
+	s_line[0].l_node = s_root = 0;
+	s_nline = 1;
+}
+
+/*
+ * routine:
+ *	s_ready
+ *
+ * purpose:
+ *	to get the tree ready to search the current position of a game
+ *
+ * parms:
+ *	game whose position is to be searched
+ *
+ * returns:
+ *	TRUE	the tree is ready
+ *	FALSE	there is no memory for the tree
+ *
+ * note:
+ *	if the root of the tree is the current position (see s_follow),
+ *	the tree is kept.  Children of the root that were added further
+ *	down the tree were only checked for simple ko, so any that turn
+ *	out to be illegal in the real game are dropped.
+ */
+static int s_ready( struct game_ctx *gp )
+{	register struct node *np;
+	register struct line *lp;
+	register int k, n;
+	struct engine *ep = gp->g_engine;
+
+	t_init();
+	if (s_nline == 0)
+		return( s_newtree( gp ) );
+	lp = &s_line[ s_nline-1 ];
+	if (lp->l_movenum != gp->g_movenum  ||  lp->l_color != gp->g_nxtcolor  ||  lp->l_hash != gp->g_hash)
+		return( s_newtree( gp ) );
+
+	if (s_tree->a_used > S_KEEPMAX)
+		s_trim();
+
+	if (s_checked)
+		return( TRUE );
+
+	/* keep only the children that are really legal */
+	np = NODE( s_root );
+	gp->g_engine = ep->e_light;
+	if (np->n_nkids > 0)
+	{	for( k = n = 0; k < np->n_nkids; k++ )
+			if (s_rootok( gp, NODE( np->n_kids + k )->n_point ))
+			{	if (n != k)
+					*NODE( np->n_kids + n ) = *NODE( np->n_kids + k );
+				n++;
+			}
+		np->n_nkids = n;
+	}
+	if (np->n_nkids <= 0)
+	{	np->n_nkids = S_BUSY;
+		s_expand( gp, s_root, TRUE );
+	}
+	gp->g_engine = ep;
+
+	if (np->n_nkids <= 0)
+		return( s_newtree( gp ) );
+	s_checked = TRUE;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	s_follow
+ *
+ * purpose:
+ *	to keep the root of the tree at the current position of a game
+ *
+ * parms:
+ *	game in which a move has just been made or taken back
+ *
+ * note:
+ *	this must be called after every move made in, or taken back from,
+ *	the console game.  A move moves the root down to the child for that
+ *	move (if there is one), and taking moves back moves it back up the
+ *	line it came down.  If the game goes anywhere the tree has not
+ *	been, the tree is forgotten.  Any pondering is carried on from the
+ *	new root.
+ */
+void s_follow( struct game_ctx *gp )
+{	register struct node *np;
+	register struct line *lp;
+	register int k;
+	int pondering = s_nponder;
+
+	if (s_nline == 0)
+		return;
+	s_ponder( gp, FALSE );
+
+	lp = &s_line[ s_nline-1 ];
+	if (gp->g_movenum == lp->l_movenum + 1)
+	{	/* a move: look for its node among the root's children */
+		np = NODE( s_root );
+		for( k = 0; k < np->n_nkids; k++ )
+			if (NODE( np->n_kids + k )->n_point ==
+					MOVE( gp, lp->l_movenum )->m_point)
+				break;
+		if (k >= np->n_nkids  ||  s_nline >= S_MAXDEPTH)
+		{	s_nline = 0;
+			return;
+		}
+
+		s_root = np->n_kids + k;
+		lp = &s_line[ s_nline++ ];
+		lp->l_node = s_root;
+		lp->l_movenum = gp->g_movenum;
+		lp->l_color = gp->g_nxtcolor;
+		lp->l_hash = gp->g_hash;
+	} else
+	{	/* moves taken back: go back up the line */
+		while( s_nline > 1  &&  lp->l_movenum > gp->g_movenum )
+		{	lp--;
+			s_nline--;
+		}
+		if (lp->l_movenum != gp->g_movenum  ||
+		    lp->l_color != gp->g_nxtcolor  ||  lp->l_hash != gp->g_hash)
+		{	s_nline = 0;
+			return;
+		}
+		s_root = lp->l_node;
+	}
+	s_checked = FALSE;
+
+	if (pondering  &&  s_nline > 0)
+		s_ponder( gp, TRUE );
+}
+
+/*
+ * routine:
+ *	s_threads
+ *
+ * purpose:
+ *	to decide how many threads to search with
+ *
+ * returns:
+ *	mc_threads, or the number of processors if that is not set
+ */
+static int s_threads()
+{	int n = mc_threads;
+
+	if (n <= 0)
+		n = (int) sysconf( _SC_NPROCESSORS_ONLN );
+	if (n <= 0)
+		n = 1;
+	if (n > S_MAXTHREADS)
+		n = S_MAXTHREADS;
+	return( n );
+}
+
+/*
+ * routine:
+ *	s_copies
+ *
+ * purpose:
+ *	to give threads their own copies of a game
+ *
+ * parms:
+ *	game to be copied
+ *	number of the first thread needing a copy
+ *	number of threads wanted
+ *
+ * returns:
+ *	number of threads that can be used
+ */
+static int s_copies( struct game_ctx *gp, int first, int count )
+{	register struct worker *wp;
+	register int k;
+
+	for( k = first, wp = &workers[k]; k < count; k++, wp++ )
+	{	if (wp->w_seed == 0)
+			wp->w_seed = k + 1;
+		if (wp->w_game == 0  &&  (wp->w_game = g_new( gp->g_size )) == 0)
+			break;
+		g_copy( wp->w_game, gp );
+	}
+
+	return( k );
+}
+
+/*
+ * routine:
+ *	s_ponder
+ *
+ * purpose:
+ *	to start or stop searching while the opponent thinks
+ *
+ * parms:
+ *	game, in the position the opponent must move from
+ *	TRUE to start pondering, FALSE to stop
+ *
+ * note:
+ *	pondering threads work only in their own copies of the game, and
+ *	so may go on while the game itself is changed.  They stop when
+ *	told to (see s_search), or when the tree reaches S_PONDERMAX nodes.
+ */
+void s_ponder( struct game_ctx *gp, int on )
+{	register int k, n;
+
+	/* stop any pondering that is under way */
+	if (s_nponder)
+	{	s_halt = TRUE;
+		for( k = 1; k <= s_nponder; k++ )
+			(void) pthread_join( workers[k].w_thread, 0 );
+		s_nponder = 0;
+		s_halt = FALSE;
+	}
+
+	if (!on  ||  !mc_ponder)
+		return;
+
+	/* search the opponent's position, without using the game itself */
+	if (!s_ready( gp ))
+		return;
+	n = s_threads();
+	if (n >= S_MAXTHREADS)
+		n = S_MAXTHREADS - 1;
+	n = s_copies( gp, 1, n + 1 ) - 1;
+
+	s_nponder = n;
+	for( k = 1; k <= n; k++ )
+		if (pthread_create( &workers[k].w_thread, 0, s_work, &workers[k] ))
+			break;
+	s_nponder = k - 1;
+}
+
+/*
+ * routine:
+ *	s_search
+ *
+ * purpose:
+ *	to choose a move for the player whose turn it is
+ *
+ * parms:
+ *	game in which the move is to be made
+ *
+ * returns:
+ *	point at which to play (0 - pass)
+ *
+ * note:
+ *	the search runs for mc_seconds, if that is set, and otherwise for
+ *	mc_playouts playouts (not counting any already in the tree).
+ */
+int s_search( struct game_ctx *gp )
+{	register struct node *cp;
+	register int k;
+	struct node *root, *best;
+	long start, elapsed;
+	int nthreads, reused, pt;
+	char *from;
+
+	/* carry on with the tree we have, or else start a new one */
+	s_ponder( gp, FALSE );
+	if (!s_ready( gp ))
+		return( 0 );
+	root = NODE( s_root );
+	reused = root->n_visits;
+
+	/* take the move from the opening book, or answer a joseki move in
+	 * the usual way, if it is sensible here */
+	from = "Book";
+	if ((pt = b_reply( gp )) == 0)
+	{	from = "Joseki";
+		pt = j_reply( gp );
+	}
+	if (pt != 0)
+	{	for( k = 0; k < root->n_nkids; k++ )
+			if (NODE( root->n_kids + k )->n_point == pt)
+			{	if (verbose)
+					d_msg( "%s: %c%d", from, COLNAME( P_COL( pt ) ),
+						P_ROW( pt ) );
+				return( pt );
+			}
+	}
+
+	/* set up the games for the threads to search in */
+	workers[0].w_game = gp;
+	if (workers[0].w_seed == 0)
+		workers[0].w_seed = 1;
+	nthreads = s_copies( gp, 1, s_threads() );
+
+	/* and search (unless there is no choice to be made) */
+	start = s_now();
+	s_deadline = start + mc_seconds * 1000L;
+	s_started = 0;
+	if (root->n_nkids > 1)
+	{	for( k = 1; k < nthreads; k++ )
+			if (pthread_create( &workers[k].w_thread, 0, s_work, &workers[k] ))
+				break;
+		nthreads = k;
+		(void) s_work( &workers[0] );
+		for( k = 1; k < nthreads; k++ )
+			(void) pthread_join( workers[k].w_thread, 0 );
+	}
+	elapsed = s_now() - start;
+
+	/* the move we have looked at most is the one we trust most */
+	best = NODE( root->n_kids );
+	for( k = 0; k < root->n_nkids; k++ )
+	{	cp = NODE( root->n_kids + k );
+		if (cp->n_visits > best->n_visits)
+			best = cp;
+	}
+
+	if (verbose)
+		d_msg( "Search: %d playouts (%d reused), %d threads, %d nodes, %ld/sec, %d%% wins",
+			root->n_visits, reused, nthreads, s_tree->a_used,
+			(root->n_visits - reused) * 1000L / (elapsed > 0 ? elapsed : 1),
+			best->n_visits ? 100 * best->n_wins / best->n_visits : 0 );
+
+	return( best->n_point );
+}
+
+/*
+ * routine:
+ *	c_search
+ *
+ * purpose:
+ *	to have the computer make a move (the c command)
+ *
+ * parms:
+ *	(optional) search budget for this and later moves
+ *	    #	- number of playouts per move
+ *	    #s	- number of seconds per move
+ *	    #t	- number of threads to search with (0 - one per cpu)
+ *	    p	- turn pondering on or off (no move is made)
+ *	    k#	- set komi (no move is made)
+ */
+void c_search( char *arg )
+{	register struct game_ctx *gp = cur_game;
+	int color = gp->g_nxtcolor;
+	int pt, n;
+	char buf[32];
+
+	if (arg  &&  *arg == 'k')
+	{	komi = atof( arg+1 );
+		s_ponder( gp, FALSE );
+		t_clear();
+		d_msg( "Komi is %g", komi );
+		return;
+	} else if (arg  &&  *arg == 'p')
+	{	mc_ponder = !mc_ponder;
+		if (!mc_ponder)
+			s_ponder( gp, FALSE );
+		d_msg( "Pondering is %s", mc_ponder ? "on" : "off" );
+		return;
+	} else if (arg  &&  *arg >= '0'  &&  *arg <= '9')
+	{	n = atoi( arg );
+		while( *arg >= '0'  &&  *arg <= '9' )
+			arg++;
+		if (*arg == 't')
+		{	mc_threads = n;
+			d_msg( "Searching with %d threads", n );
+			return;
+		} else if (*arg == 's')
+			mc_seconds = n;
+		else
+		{	mc_playouts = n;
+			mc_seconds = 0;
+		}
+	}
+
+	if (!darkness)
+		d_msg( "Thinking ..." );
+	pt = s_search( gp );
+
+	if (pt == 0)
+		c_move( color, "-", 0 );
+	else
+	{	(void) sprintf( buf, "%c%d", COLNAME( P_COL( pt ) ), P_ROW( pt ) );
+		c_move( color, buf, 0 );
+	}
+
+	/* and think on while the opponent does */
+	s_ponder( gp, TRUE );
+}
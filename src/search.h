@@ -0,0 +1,98 @@
+/*
+ * module:
+ *	search.h
+ *
+ * purpose:
+ *	to describe the tree used by the Monte Carlo move generator
+ */
+
+/*
+ * The search tree is made of nodes, each describing one move and the
+ * results of the playouts that have gone through it.  The children of a
+ * node (the replies to its move) are kept together, so a node need only
+ * know where the first of them is and how many there are.  Nodes are
+ * allocated from an arena (see below).
+ *
+ * A node is expanded (given children) once it has been visited
+ * S_EXPAND times.  Its children are all of the legal moves for the player
+ * to move, other than those that would fill that player's own eyes,
+ * those on points that either player holds for good (see benson.c), and
+ * those that would run from a ladder in vain (see ladder.c).  When
+ * there are no such moves, the only child is a pass.  Win counts are kept
+ * from the point of view of the player who made the node's move, so each
+ * player simply prefers the children with the best records.
+ *
+ * Several threads search the same tree at once (each with its own copy
+ * of the game).  The counts in a node are only changed by atomic adds,
+ * and a node is expanded by whichever thread first claims it (by
+ * changing n_nkids from S_LEAF to S_BUSY); the others treat it as a leaf
+ * until its children are all in place.  A thread going down through a
+ * node counts S_VLOSS visits (but no wins) in advance, and settles up
+ * when its playout is over.  Until then the node looks worse than it
+ * is (a "virtual loss"), which steers the other threads to other lines.
+ *
+ * The tree is kept from one move to the next.  As moves are made (or
+ * taken back) in the game, the root moves down to the child for the
+ * move (or back up the line it came down), so that whatever was
+ * learned about the new position is kept.  The line from the top of
+ * the tree to the root is remembered (see struct line) for this.  The
+ * nodes above and beside the root are only given back when the arena
+ * holding them gets too full: the root's subtree is then copied into
+ * the other arena, and the whole of the old one is released at once.
+ */
+struct node
+{	short	n_point;	/* point of this node's move (0 - pass) */
+	short	n_nkids;	/* number of children (or S_LEAF, S_BUSY) */
+	int	n_kids;		/* number of the first child */
+	int	n_visits;	/* playouts made through this node */
+	int	n_wins;		/* playouts won by the player who moved */
+};
+
+#define S_LEAF		-1	/* n_nkids: node not yet expanded */
+#define S_BUSY		-2	/* n_nkids: node being expanded */
+
+/*
+ * an arena of nodes.  Nodes are named by number (the top of the tree is
+ * node 0), and kept in chunks of S_CHUNK nodes, which are never moved
+ * once allocated, so node n must always be found with NODE(n).  The
+ * children of a node never straddle two chunks.
+ */
+#define S_CHUNKSHIFT	16			/* log2( S_CHUNK ) */
+#define S_CHUNK		(1 << S_CHUNKSHIFT)	/* nodes per chunk */
+#define S_MAXCHUNKS	1024			/* most chunks in a tree */
+
+struct arena
+{	struct node *a_chunk[ S_MAXCHUNKS ];	/* chunks of nodes */
+	int	a_nchunks;	/* number of chunks allocated */
+	int	a_used;		/* number of the next free node */
+};
+
+#define A_NODE(ap,n)	(&(ap)->a_chunk[ (n) >> S_CHUNKSHIFT ][ (n) & (S_CHUNK-1) ])
+#define NODE(n)		A_NODE( s_tree, n )
+
+/*
+ * the line of play from the top of the tree down to its root.  Each
+ * position along it is described well enough to tell whether the game
+ * is (still, or once again) there.
+ */
+struct line
+{	int	l_node;		/* number of the node for the position */
+	int	l_movenum;	/* number of the next move */
+	int	l_color;	/* player to make it */
+	hash_t	l_hash;		/* position hash */
+};
+
+#define S_EXPAND	2	/* visits before a node is expanded */
+#define S_UCT		0.7	/* weight of exploration in choosing moves */
+#define S_VLOSS		3	/* visits charged in advance by a thread */
+#define S_MAXDEPTH	512	/* deepest line followed in the tree */
+#define S_MAXTHREADS	64	/* most threads in a search */
+#define S_PONDERMAX	(64 * S_CHUNK)	/* most nodes grown by pondering */
+#define S_KEEPMAX	(S_PONDERMAX / 2) /* nodes kept before the tree is trimmed */
+#define S_PRIOR		8	/* most visits taken from the transposition table */
+#define S_PATTERN	8	/* visits of prior given by a move's pattern */
+#define S_RATE		65536	/* winning rates are kept in 65536ths */
+
+/* atomic operations on the counts in a node (returning the old value) */
+#define S_ADD(var,n)	__sync_fetch_and_add( &(var), n )
+#define S_CLAIM(var,old,new) __sync_bool_compare_and_swap( &(var), old, new )
@@ -8,7 +8,8 @@
  */
 
 /*
- * The string board associates positions on the board with existing
+ * The string board (g_str in the game context, see game.h) associates
+ * points on the board (numbered as described in go.h) with existing
  * strings.  For each position on the board, it indicates the move
  * number associated with the top node for the associated string.
  * For convenience, it also contains a little bit more information
@@ -16,9 +17,77 @@
  *
  * note that a move number of 0 indicates a vacant point, and a move
  *	number of -1 indicates a border (unavailable point).
+ *
+ * The stones of each string are also linked into a ring through s_next,
+ * so that all of the stones in a string can be visited with a simple
+ * loop (rather than by walking the tree of subsumed moves in move.h).
+ * When a stone joins strings together, their rings are spliced into its
+ * own by exchanging s_next links.  Since such an exchange is its own
+ * inverse, un-doing the same exchanges in the opposite order splits the
+ * rings back apart exactly.  Points vacated by a kill keep their links,
+ * so the ring of a dead string is still intact when the kill is undone;
+ * a stone later played on such a point saves what it found there (in
+ * the move structure) and puts it back when it is taken back.  s_stone
+ * is the number of the move that placed the stone, for redisplay.
  */
 struct string
 {	short	s_moveno;	/* move number of string description node */
 	char	s_color;	/* color of group that owns this string */
 	char	s_flags;	/* I had to pad it out with something */
-} str_board[ MAXBOARD + 2 ][ MAXBOARD + 2 ];
+	short	s_next;		/* point of next stone in this ring */
+	short	s_stone;	/* move number of the stone at this point */
+};
+
+/*
+ * The vacant points are kept track of in much the same way, gathered
+ * into regions (connected sets of vacant points).  The region board
+ * (g_rgn in the game context) gives the number of the region each
+ * vacant point belongs to, and the points of each region are linked
+ * into a ring through g_rnext and g_rprev (both ways, since points
+ * leave regions from the middle of their rings).  The engines keep the
+ * regions up to date as stones come and go: a stone taken off of the
+ * board joins (and may merge) the regions around it, and a stone put
+ * on the board leaves its region, which it may split apart.  Whether
+ * it does is usually clear from the eight points around it; only when
+ * it is not is the region searched.  Region numbers are not kept from
+ * one position to the next, so they should not be remembered.
+ *
+ * Only the full engines keep the regions.  The light engines leave
+ * them alone, since playouts only want them once, to score the final
+ * position (which p_score does by searching its regions out afresh).
+ * While light moves are on the board the regions are out of date, and
+ * they are right again once those moves have been taken back.
+ *
+ * e_touch counts the pairs of a vacant point in the region and a stone
+ * next to it, for each color of stone, so a region is bounded by a
+ * color if its count is not zero.  The strings next to a region can
+ * be found by walking its ring.
+ */
+struct region
+{	short	e_size;		/* number of points in the region */
+	short	e_point;	/* one of them (where its ring starts) */
+	short	e_touch[2];	/* points next to stones of each color */
+};
+
+#define E_MAXREGIONS	(MAXBOARD * MAXBOARD)	/* most regions on a board */
+#define E_MAXGEN	30000	/* search marks are cleared past this */
+
+/* colors bounding a region, as a mask of (1 << color) */
+#define E_COLORS(rp)	(((rp)->e_touch[BLACK] > 0) << BLACK | \
+			 ((rp)->e_touch[WHITE] > 0) << WHITE)
+
+/*
+ * Each point also has a pattern code (g_pat in the game context), that
+ * describes the eight points around it (in the order of p_ring, with
+ * its neighbors at the even places): two bits give the state of each
+ * of those points.  The codes are kept up to date by all of the
+ * engines, so the pattern around a point can be looked up with a
+ * single index.
+ */
+#define X_EMPTY		0		/* vacant point */
+#define X_STONE(color)	((color) + 1)	/* stone of a color */
+#define X_EDGE		3		/* off of the board */
+#define X_SHIFT(i)	(2 * (i))	/* where ring point i's state is */
+#define X_STATE(code,i)	((int) ((code) >> X_SHIFT( i )) & 3)
+#define X_STATES	0xffffL		/* the states of all eight points */
+#define X_CODES		0x10000L	/* number of different codes */
@@ -0,0 +1,196 @@
+/*
+ * module:
+ *	superko.c
+ *
+ * purpose:
+ *	to remember every position that has occurred in a game, so that
+ *	moves which would recreate an earlier position can be rejected
+ *	(positional superko).
+ *
+ * note:
+ *	the positions are kept as their zobrist hashes (see zobrist.h) in
+ *	a linear probing hash table.  Positions enter the table as moves
+ *	are made (m_do) and leave it as they are unmade (m_unmove), so the
+ *	table always describes exactly the line of play that led to the
+ *	current position.  The same hash may be entered more than once
+ *	(e.g. by imaginary moves that didn't bother to check for superko),
+ *	so each removal only takes out a single copy.  The empty board
+ *	hashes to zero, which we also use to mark free slots in the table,
+ *	so it is never entered (no move can recreate the empty board).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "go.h"
+#include "move.h"
+#include "libs.h"
+#include "strings.h"
+#include "game.h"
+
+#define K_MINSIZE	1024	/* initial size of the table (power of 2) */
+
+/*
+ * routine:
+ *	k_reset
+ *
+ * purpose:
+ *	to forget all of the positions seen in a game
+ *
+ * parms:
+ *	game to be reset
+ */
+void k_reset( struct game_ctx *gp )
+{	register hash_t *hp, *ep;
+
+	gp->g_nseen = 0;
+	if (gp->g_seen == 0)
+	{	gp->g_seen = (hash_t *) malloc( K_MINSIZE * sizeof (hash_t) );
+		if (gp->g_seen == 0)
+		{	d_msg( "Unable to allocate superko table" );
+			return;
+		}
+		gp->g_seenmask = K_MINSIZE - 1;
+	}
+
+	ep = &gp->g_seen[ gp->g_seenmask + 1 ];
+	for( hp = gp->g_seen; hp < ep; hp++ )
+		*hp = 0;
+}
+
+/*
+ * routine:
+ *	k_grow
+ *
+ * purpose:
+ *	to double the size of a game's position table
+ *
+ * parms:
+ *	game whose table is to grow
+ *
+ * returns:
+ *	TRUE	table was enlarged
+ *	FALSE	unable to allocate a larger table
+ */
+static int k_grow( struct game_ctx *gp )
+{	register hash_t *hp, *np;
+	register int i;
+	hash_t *old = gp->g_seen;
+	int oldsize = gp->g_seenmask + 1;
+	int mask = (oldsize << 1) - 1;
+
+	np = (hash_t *) calloc( mask + 1, sizeof (hash_t) );
+	if (np == 0)
+		return( FALSE );
+
+	/* re-enter every position into the new table */
+	for( hp = old; hp < &old[ oldsize ]; hp++ )
+	{	if (*hp == 0)
+			continue;
+		for( i = (int) *hp & mask; np[i]; i = (i + 1) & mask );
+		np[i] = *hp;
+	}
+
+	free( (char *) old );
+	gp->g_seen = np;
+	gp->g_seenmask = mask;
+	return( TRUE );
+}
+
+/*
+ * routine:
+ *	k_add
+ *
+ * purpose:
+ *	to note that a position has occurred in a game
+ *
+ * parms:
+ *	game in which the position occurred
+ *	hash of the position
+ */
+void k_add( struct game_ctx *gp, hash_t hash )
+{	register hash_t *tp;
+	register int i, mask;
+
+	if (hash == 0  ||  gp->g_seen == 0)
+		return;
+
+	/* keep the table no more than half full */
+	if (2 * (gp->g_nseen + 1) > gp->g_seenmask + 1  &&  !k_grow( gp ))
+	{	d_msg( "*** superko table is full" );
+		return;
+	}
+
+	tp = gp->g_seen;
+	mask = gp->g_seenmask;
+	for( i = (int) hash & mask; tp[i]; i = (i + 1) & mask );
+	tp[i] = hash;
+	gp->g_nseen++;
+}
+
+/*
+ * routine:
+ *	k_remove
+ *
+ * purpose:
+ *	to forget one occurrence of a position in a game
+ *
+ * parms:
+ *	game in which the position occurred
+ *	hash of the position
+ *
+ * note:
+ *	rather than leave tombstones, we close up the gap behind the
+ *	deleted entry by moving back any later members of the probe
+ *	sequence that would no longer be reachable.
+ */
+void k_remove( struct game_ctx *gp, hash_t hash )
+{	register hash_t *tp = gp->g_seen;
+	register int i, j, mask = gp->g_seenmask;
+	int home;
+
+	if (hash == 0  ||  gp->g_nseen == 0)
+		return;
+
+	/* find the entry */
+	for( i = (int) hash & mask; tp[i] != hash; i = (i + 1) & mask )
+		if (tp[i] == 0)
+			return;		/* it wasn't there */
+
+	/* shift back any entries that probed past it */
+	for( j = (i + 1) & mask; tp[j]; j = (j + 1) & mask )
+	{	home = (int) tp[j] & mask;
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{	tp[i] = tp[j];
+			i = j;
+		}
+	}
+	tp[i] = 0;
+	gp->g_nseen--;
+}
+
+/*
+ * routine:
+ *	k_count
+ *
+ * purpose:
+ *	to determine how many times a position has occurred in a game
+ *
+ * parms:
+ *	game to be checked
+ *	hash of the position
+ *
+ * returns:
+ *	number of occurrences (0 if never seen)
+ */
+int k_count( struct game_ctx *gp, hash_t hash )
+{	register hash_t *tp = gp->g_seen;
+	register int i, mask = gp->g_seenmask;
+	register int n = 0;
+
+	if (hash == 0  ||  gp->g_nseen == 0)
+		return( 0 );
+
+	for( i = (int) hash & mask; tp[i]; i = (i + 1) & mask )
+		if (tp[i] == hash)
+			n++;
+	return( n );
+}
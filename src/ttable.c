@@ -0,0 +1,237 @@
+/*
+ * module:
+ *	ttable.c
+ *
+ * purpose:
+ *	to remember what is known about positions in a transposition table
+ *
+ * note:
+ *	see ttable.h for how the table is organized, and why it needs no
+ *	locks.  The table is allocated when it is first needed, and may
+ *	be resized (which empties it) with the t option.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "go.h"
+#include "ttable.h"
+
+static struct tbucket *t_table;	/* the buckets (aligned) */
+static char *t_space;		/* the memory holding them */
+static hash_t t_mask;		/* number of buckets - 1 */
+static int t_megs = T_DEFSIZE;	/* size of the table (megabytes) */
+static struct tstats t_stats;	/* how the table has been used */
+static __thread struct tstats t_mine; /* this thread's use, not yet in t_stats */
+
+/*
+ * routine:
+ *	t_resize
+ *
+ * purpose:
+ *	to set the size of the transposition table
+ *
+ * parms:
+ *	size in megabytes (0 - no table)
+ *
+ * note:
+ *	the number of buckets is rounded down to a power of two.  This must
+ *	not be called while any thread is searching.
+ */
+void t_resize( int megs )
+{	register long n;
+
+	if (t_space)
+		free( t_space );
+	t_space = 0;
+	t_table = 0;
+	t_mask = 0;
+	t_megs = (megs > 0) ? megs : 0;
+	if (t_megs == 0)
+		return;
+
+	for( n = 1; 2 * n * sizeof (struct tbucket) <= t_megs * 1024L * 1024L; n *= 2 )
+		;
+
+	if ((t_space = malloc( n * sizeof (struct tbucket) + T_LINE )) == 0)
+	{	d_msg( "Unable to allocate a %d megabyte transposition table", t_megs );
+		t_megs = 0;
+		return;
+	}
+	t_table = (struct tbucket *) (((unsigned long) t_space + T_LINE - 1) &
+			~(unsigned long) (T_LINE - 1));
+	t_mask = n - 1;
+	t_clear();
+}
+
+/*
+ * routine:
+ *	t_init
+ *
+ * purpose:
+ *	to make sure the transposition table has been allocated
+ *
+ * note:
+ *	like t_resize, this must not be called while threads are searching
+ */
+void t_init()
+{
+	if (t_table == 0  &&  t_megs > 0)
+		t_resize( t_megs );
+}
+
+/*
+ * routine:
+ *	t_clear
+ *
+ * purpose:
+ *	to forget everything in the transposition table
+ */
+void t_clear()
+{
+	if (t_table)
+		memset( (char *) t_table, 0, (t_mask + 1) * sizeof (struct tbucket) );
+	memset( (char *) &t_stats, 0, sizeof t_stats );
+	memset( (char *) &t_mine, 0, sizeof t_mine );
+}
+
+/*
+ * routine:
+ *	t_flush
+ *
+ * purpose:
+ *	to add this thread's use of the table into the statistics
+ *
+ * note:
+ *	the counts are kept by each thread, so that threads probing the
+ *	table at once neither lose counts nor fight over the cache line
+ *	holding them.  A thread that searches calls this when it stops.
+ */
+void t_flush()
+{
+	(void) __sync_fetch_and_add( &t_stats.t_probes, t_mine.t_probes );
+	(void) __sync_fetch_and_add( &t_stats.t_hits, t_mine.t_hits );
+	(void) __sync_fetch_and_add( &t_stats.t_stores, t_mine.t_stores );
+	(void) __sync_fetch_and_add( &t_stats.t_replaced, t_mine.t_replaced );
+	memset( (char *) &t_mine, 0, sizeof t_mine );
+}
+
+/*
+ * routine:
+ *	t_probe
+ *
+ * purpose:
+ *	to look a position up in the transposition table
+ *
+ * parms:
+ *	position key (see T_KEY)
+ *	where to put the data word, if it is found
+ *
+ * returns:
+ *	TRUE	the position was found
+ *	FALSE	the position is not in the table
+ */
+int t_probe( hash_t key, hash_t *datap )
+{	register struct tentry *ep;
+	register hash_t data;
+	register int i;
+
+	if (t_table == 0)
+		return( FALSE );
+	t_mine.t_probes++;
+
+	ep = t_table[ key & t_mask ].b_entry;
+	for( i = 0; i < T_WAYS; i++, ep++ )
+	{	data = ep->t_data;
+		if ((ep->t_check ^ data) == key  &&  T_DEPTH( data ) > 0)
+		{	t_mine.t_hits++;
+			*datap = data;
+			return( TRUE );
+		}
+	}
+
+	return( FALSE );
+}
+
+/*
+ * routine:
+ *	t_store
+ *
+ * purpose:
+ *	to remember something about a position in the transposition table
+ *
+ * parms:
+ *	position key (see T_KEY)
+ *	depth (greater than zero)
+ *	flags
+ *	value
+ *
+ * note:
+ *	an entry already held for the position is only replaced by one of
+ *	at least the same depth.  Otherwise, the shallowest entry in the
+ *	bucket is replaced.
+ */
+void t_store( hash_t key, int depth, int flags, int value )
+{	register struct tentry *ep, *victim;
+	register hash_t data;
+	register int i;
+
+	if (t_table == 0  ||  depth <= 0)
+		return;
+	if (depth > T_MAXDEPTH)
+		depth = T_MAXDEPTH;
+
+	ep = t_table[ key & t_mask ].b_entry;
+	victim = ep;
+	for( i = 0; i < T_WAYS; i++, ep++ )
+	{	data = ep->t_data;
+		if ((ep->t_check ^ data) == key)
+		{	if (T_DEPTH( data ) > depth)
+				return;
+			victim = ep;
+			break;
+		}
+		if (T_DEPTH( data ) < T_DEPTH( victim->t_data ))
+			victim = ep;
+	}
+
+	if (i == T_WAYS  &&  T_DEPTH( victim->t_data ) > 0)
+		t_mine.t_replaced++;
+	t_mine.t_stores++;
+
+	data = T_DATA( depth, flags, value );
+	victim->t_data = data;
+	victim->t_check = key ^ data;
+}
+
+/*
+ * routine:
+ *	t_show
+ *
+ * purpose:
+ *	to report on the use of the transposition table (the D h command)
+ *
+ * note:
+ *	threads that are still searching (pondering) have yet to add in
+ *	their counts
+ */
+void t_show()
+{	register long n, used;
+	register int i;
+
+	if (t_table == 0)
+	{	d_msg( "TABLE: none" );
+		return;
+	}
+	t_flush();
+
+	for( n = used = 0; n <= t_mask; n++ )
+		for( i = 0; i < T_WAYS; i++ )
+			if (T_DEPTH( t_table[n].b_entry[i].t_data ) > 0)
+				used++;
+
+	d_msg( "TABLE: %d MB, %ld of %ld in use; %ld probes, %ld hits (%d%%), %ld stores, %ld replaced",
+		t_megs, used, (t_mask + 1) * T_WAYS, t_stats.t_probes,
+		t_stats.t_hits, t_stats.t_probes ?
+		(int) (100 * t_stats.t_hits / t_stats.t_probes) : 0,
+		t_stats.t_stores, t_stats.t_replaced );
+}
@@ -0,0 +1,59 @@
+/*
+ * module:
+ *	ttable.h
+ *
+ * purpose:
+ *	to describe the transposition table, in which what is known about
+ *	positions is remembered, no matter how they were reached
+ */
+
+/*
+ * The table is shared by all of the threads that search, and is used
+ * without locks.  Each entry holds a 64-bit data word and a check word,
+ * which is the data exclusive-or'ed with the position's key.  The two
+ * words are written separately, so a reader may see half of an entry
+ * that another thread is writing; but then the check won't match the
+ * key, and the entry is simply not found.  A position's key is its
+ * position hash (see zobrist.h), with a key for the player to move.
+ *
+ * The data word holds a depth (how much work lies behind the value, so
+ * larger is better), sixteen bits of flags and a 32-bit value, whose
+ * meanings are up to the module that stored them.  An entry with a
+ * depth of zero is empty.
+ *
+ * Entries are kept in buckets of T_WAYS, each the size (and alignment)
+ * of a cache line, and a key may only be kept in the bucket its low
+ * order bits pick.  When a bucket is full, a new entry replaces the one
+ * with the least depth.
+ */
+struct tentry
+{	volatile hash_t	t_check;	/* key ^ data */
+	volatile hash_t	t_data;		/* depth, flags and value */
+};
+
+#define T_WAYS		4	/* entries per bucket */
+#define T_LINE		64	/* bytes per bucket (a cache line) */
+#define T_DEFSIZE	16	/* default size (megabytes) */
+
+struct tbucket
+{	struct tentry b_entry[ T_WAYS ];
+};
+
+/* packing and unpacking the data word */
+#define T_DATA(depth,flags,value) ((hash_t) (depth) << 48 | \
+		(hash_t) ((flags) & 0xffff) << 32 | (unsigned) (value))
+#define T_DEPTH(data)	((int) ((data) >> 48))
+#define T_FLAGS(data)	((int) ((data) >> 32) & 0xffff)
+#define T_VALUE(data)	((int) (data))
+#define T_MAXDEPTH	0xffff
+
+/* key for the player to move (white), from the unused keys for point 0 */
+#define T_KEY(hash,color) ((hash) ^ ((color) == WHITE ? z_keys[WHITE][0] : 0))
+
+/* statistics: each thread keeps its own, and adds them in when it is done */
+struct tstats
+{	long	t_probes;	/* lookups */
+	long	t_hits;		/* lookups that found their entry */
+	long	t_stores;	/* entries stored */
+	long	t_replaced;	/* other positions' entries replaced */
+};
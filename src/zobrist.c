@@ -0,0 +1,47 @@
+/*
+ * module:
+ *	zobrist.c
+ *
+ * purpose:
+ *	to generate the random keys used to compute position hashes
+ */
+#include <stdio.h>
+#include "go.h"
+#include "zobrist.h"
+
+#define Z_SEED	0x9e3779b97f4a7c15ULL	/* arbitrary, but fixed, seed */
+
+/*
+ * routine:
+ *	z_init
+ *
+ * purpose:
+ *	to fill in the table of position hash keys
+ *
+ * note:
+ *	the keys come from a splitmix64 generator, which is tiny and
+ *	produces well distributed 64-bit values from a simple counter.
+ *	The table only needs to be built once, no matter how many games
+ *	are created.
+ */
+void z_init()
+{	static int done;
+	register hash_t *kp, *ep;
+	hash_t x, z;
+
+	if (done)
+		return;
+
+	x = Z_SEED;
+	kp = &z_keys[0][0];
+	ep = kp + (sizeof z_keys / sizeof *kp);
+	while( kp < ep )
+	{	x += 0x9e3779b97f4a7c15ULL;
+		z = x;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		*kp++ = z ^ (z >> 31);
+	}
+
+	done = TRUE;
+}
@@ -0,0 +1,27 @@
+/*
+ * module:
+ *	zobrist.h
+ *
+ * purpose:
+ *	to describe the random keys from which position hashes are built
+ */
+
+/*
+ * Each game keeps a 64-bit hash (g_hash) of the stones on its board.
+ * The hash is the exclusive-or of a random key for the color and point
+ * of every stone that is on the board.  Because exclusive-or is its own
+ * inverse, the same operation that adds a stone to the hash removes it
+ * again, so the hash can be maintained (in constant time) by the routines
+ * that put stones onto, and take stones off of, the string board.  Two
+ * identical positions will always have identical hashes, no matter what
+ * sequence of moves produced them.
+ *
+ * The keys are shared by all games, and are generated from a fixed seed
+ * so that hashes are comparable between runs of the program.
+ */
+hash_t z_keys[2][ P_POINTS ];
+
+/* hash key for a stone of a given color at a given point */
+#define Z_STONE(color,pt)	(z_keys[color][pt])
+
+void z_init();